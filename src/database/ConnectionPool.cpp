@@ -0,0 +1,163 @@
+#include "ConnectionPool.h"
+#include <QSqlQuery>
+#include <QSqlError>
+#include <QThread>
+#include <QDebug>
+
+ConnectionPool::ConnectionPool() = default;
+
+ConnectionPool::~ConnectionPool()
+{
+    closeAll();
+}
+
+void ConnectionPool::configure(const QString& dbPath, const QStringList& pragmas)
+{
+    const QMutexLocker locker(&m_mutex);
+    m_dbPath = dbPath;
+    m_pragmas = pragmas;
+    ++m_pragmaGeneration;
+}
+
+void ConnectionPool::setPragmas(const QStringList& pragmas)
+{
+    const QMutexLocker locker(&m_mutex);
+    m_pragmas = pragmas;
+    ++m_pragmaGeneration;
+}
+
+ConnectionPool::Connection* ConnectionPool::acquire()
+{
+    QThread* thread = QThread::currentThread();
+
+    QString dbPath;
+    QStringList pragmas;
+    int pragmaGeneration = 0;
+    QString connectionName;
+    Connection* existing = nullptr;
+    {
+        const QMutexLocker locker(&m_mutex);
+        const auto it = m_connections.find(thread);
+        if (it != m_connections.end()) {
+            existing = it->second.get();
+            if (existing->pragmaGeneration == m_pragmaGeneration) return existing;
+        }
+
+        dbPath = m_dbPath;
+        pragmas = m_pragmas;
+        pragmaGeneration = m_pragmaGeneration;
+        if (!existing) connectionName = QString("fleet_%1").arg(m_nextConnectionId++);
+    }
+
+    // Набор PRAGMA сменился - применяем его к уже открытому соединению.
+    // Соединение принадлежит текущему потоку, другие потоки его не трогают.
+    // При ошибке версия не обновляется: следующий acquire() повторит попытку
+    if (existing) {
+        if (!applyPragmas(existing->database, pragmas)) return nullptr;
+        existing->pragmaGeneration = pragmaGeneration;
+        return existing;
+    }
+
+    // Соединение создаётся и открывается в том потоке, который будет его использовать
+    auto connection = std::make_unique<Connection>();
+    connection->database = QSqlDatabase::addDatabase("QSQLITE", connectionName);
+    connection->database.setDatabaseName(dbPath);
+
+    if (!connection->database.open()) {
+        qWarning() << "Не удалось открыть соединение" << connectionName << ":"
+                   << connection->database.lastError().text();
+        closeConnection(std::move(connection));
+        return nullptr;
+    }
+
+    // Соединение с другим режимом журнала или без нужных настроек не выдаём
+    if (!applyPragmas(connection->database, pragmas)) {
+        qWarning() << "Соединение" << connectionName << "закрыто: PRAGMA профиля не применены";
+        closeConnection(std::move(connection));
+        return nullptr;
+    }
+    connection->pragmaGeneration = pragmaGeneration;
+
+    const QMutexLocker locker(&m_mutex);
+
+    // Соединение закрывается в своём потоке перед его завершением
+    // (у главного потока finished не испускается - его закрывает closeAll).
+    // Обработчик ставится один раз на запуск потока: повторное открытие
+    // соединения после release() (смена профиля) не добавляет новых
+    if (!m_finishHooks.contains(thread)) {
+        m_finishHooks.insert(thread);
+        QObject::connect(thread, &QThread::finished, thread, [this, thread]() {
+            {
+                const QMutexLocker locker(&m_mutex);
+                m_finishHooks.remove(thread);
+            }
+            release();
+        }, static_cast<Qt::ConnectionType>(Qt::DirectConnection | Qt::SingleShotConnection));
+    }
+
+    Connection* result = connection.get();
+    m_connections.emplace(thread, std::move(connection));
+    return result;
+}
+
+void ConnectionPool::release()
+{
+    std::unique_ptr<Connection> connection;
+    {
+        const QMutexLocker locker(&m_mutex);
+        const auto it = m_connections.find(QThread::currentThread());
+        if (it == m_connections.end()) return;
+        connection = std::move(it->second);
+        m_connections.erase(it);
+    }
+    closeConnection(std::move(connection));
+}
+
+void ConnectionPool::closeAll()
+{
+    std::unordered_map<QThread*, std::unique_ptr<Connection>> connections;
+    {
+        const QMutexLocker locker(&m_mutex);
+        connections.swap(m_connections);
+    }
+    for (auto& entry : connections)
+        closeConnection(std::move(entry.second));
+}
+
+void ConnectionPool::closeConnection(std::unique_ptr<Connection> connection)
+{
+    if (!connection) return;
+
+    // Подготовленные запросы должны быть освобождены до закрытия соединения
+    connection->statements.clear();
+
+    const QString connectionName = connection->database.connectionName();
+    if (connection->database.isOpen()) connection->database.close();
+    connection->database = QSqlDatabase();
+
+    if (!connectionName.isEmpty())
+        QSqlDatabase::removeDatabase(connectionName);
+}
+
+bool ConnectionPool::applyPragmas(const QSqlDatabase& database, const QStringList& pragmas)
+{
+    bool success = true;
+    QSqlQuery pragma(database);
+    for (const QString& statement : pragmas) {
+        if (!pragma.exec(statement)) {
+            qWarning() << "Ошибка выполнения" << statement << ":" << pragma.lastError().text();
+            success = false;
+        } else if (statement.contains("journal_mode")) {
+            // SQLite не считает ошибкой отказ сменить режим (например, выйти из
+            // WAL при других открытых соединениях) - сверяем фактический режим
+            const QString requested = statement.section('=', 1).trimmed();
+            const QString actual = pragma.next() ? pragma.value(0).toString() : QString();
+            if (actual.compare(requested, Qt::CaseInsensitive) != 0) {
+                qWarning() << "Режим журнала" << requested << "не установлен, действует" << actual;
+                success = false;
+            }
+        }
+        pragma.finish();
+    }
+    return success;
+}
@@ -0,0 +1,97 @@
+#pragma once
+
+#include <QMutex>
+#include <QSet>
+#include <QSqlDatabase>
+#include <QString>
+#include <QStringList>
+#include <memory>
+#include <unordered_map>
+
+class QSqlQuery;
+class QThread;
+
+/**
+ * @brief Пул соединений SQLite: по одному именованному соединению на поток
+ *
+ * Соединения Qt нельзя использовать из разных потоков, поэтому каждый
+ * поток получает своё соединение при первом обращении. На каждом новом
+ * соединении выполняются одни и те же PRAGMA. Соединение закрывается
+ * в своём потоке при его завершении или явно через release().
+ *
+ * Общей блокировки доступа к базе нет: параллельные чтения и запись
+ * разводит SQLite (WAL и busy_timeout из PRAGMA профиля). Кэш
+ * подготовленных запросов принадлежит соединению и используется только
+ * его потоком.
+ */
+class ConnectionPool {
+public:
+    /**
+     * @brief Соединение потока и его кэш подготовленных запросов
+     */
+    struct Connection {
+        QSqlDatabase database;
+        std::unordered_map<QString, std::unique_ptr<QSqlQuery>> statements;
+        int pragmaGeneration = 0;       // Версия набора PRAGMA, применённого к соединению
+    };
+
+    ConnectionPool();
+    ~ConnectionPool();
+
+    ConnectionPool(const ConnectionPool&) = delete;
+    ConnectionPool& operator=(const ConnectionPool&) = delete;
+
+    /**
+     * @brief Задать файл базы и PRAGMA для новых соединений
+     * @param dbPath Путь к файлу базы данных
+     * @param pragmas Команды PRAGMA, выполняемые на каждом новом соединении
+     */
+    void configure(const QString& dbPath, const QStringList& pragmas);
+
+    /**
+     * @brief Заменить набор PRAGMA
+     *
+     * Уже открытые соединения применяют новый набор при следующем
+     * acquire() в своём потоке. Режим журнала так сменить нельзя, пока
+     * открыты другие соединения: их нужно сначала закрыть (release()).
+     */
+    void setPragmas(const QStringList& pragmas);
+
+    /**
+     * @brief Получить соединение текущего потока, открыв его при необходимости
+     * @return Указатель на соединение или nullptr, если открыть его или
+     *         применить PRAGMA (в том числе режим журнала) не удалось
+     */
+    Connection* acquire();
+
+    /**
+     * @brief Закрыть соединение текущего потока
+     */
+    void release();
+
+    /**
+     * @brief Закрыть все соединения (при завершении работы)
+     */
+    void closeAll();
+
+private:
+    /**
+     * @brief Освободить запросы, закрыть соединение и удалить его из Qt
+     */
+    static void closeConnection(std::unique_ptr<Connection> connection);
+
+    /**
+     * @brief Выполнить PRAGMA на соединении
+     * @return true, если все команды выполнены успешно и SQLite
+     *         установила запрошенный режим журнала
+     */
+    static bool applyPragmas(const QSqlDatabase& database, const QStringList& pragmas);
+
+    QMutex m_mutex;                                  // Защищает m_connections и настройки
+    std::unordered_map<QThread*, std::unique_ptr<Connection>> m_connections;
+    QSet<QThread*> m_finishHooks;                    // Потоки с обработчиком finished
+    QString m_dbPath;
+    QStringList m_pragmas;
+    int m_nextConnectionId = 0;
+    int m_pragmaGeneration = 0;
+};
@@ -0,0 +1,29 @@
+#include "DatabaseWorker.h"
+
+DatabaseWorker::DatabaseWorker()
+    : m_thread(std::make_unique<QThread>())
+    , m_context(std::make_unique<QObject>())
+{
+    m_thread->setObjectName("FleetDatabaseWorker");
+    m_context->moveToThread(m_thread.get());
+}
+
+DatabaseWorker::~DatabaseWorker()
+{
+    stop();
+}
+
+void DatabaseWorker::start()
+{
+    if (!m_thread->isRunning()) m_thread->start();
+}
+
+void DatabaseWorker::stop()
+{
+    if (!m_thread->isRunning()) return;
+
+    // quit() ставится в очередь после уже принятых задач
+    QMetaObject::invokeMethod(m_context.get(), [thread = m_thread.get()]() { thread->quit(); },
+                              Qt::QueuedConnection);
+    m_thread->wait();
+}
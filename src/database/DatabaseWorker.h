@@ -0,0 +1,66 @@
+#pragma once
+
+#include <QFuture>
+#include <QObject>
+#include <QPromise>
+#include <QThread>
+#include <memory>
+#include <type_traits>
+
+/**
+ * @brief Фоновый поток для выполнения запросов к базе данных
+ *
+ * Задачи выполняются строго по очереди в отдельном потоке, результат
+ * возвращается через QFuture. Соединение с базой этот поток получает
+ * из ConnectionPool при первом запросе (соединения Qt нельзя
+ * передавать между потоками).
+ */
+class DatabaseWorker {
+public:
+    DatabaseWorker();
+    ~DatabaseWorker();
+
+    DatabaseWorker(const DatabaseWorker&) = delete;
+    DatabaseWorker& operator=(const DatabaseWorker&) = delete;
+
+    /**
+     * @brief Запустить поток
+     */
+    void start();
+
+    /**
+     * @brief Дождаться выполнения поставленных задач и остановить поток
+     */
+    void stop();
+
+    /**
+     * @brief Поток, в котором выполняются задачи
+     */
+    QThread* thread() const { return m_thread.get(); }
+
+    /**
+     * @brief Поставить задачу в очередь фонового потока
+     * @param job Функция без аргументов, возвращающая результат
+     * @return QFuture с результатом выполнения задачи
+     */
+    template <typename Job>
+    auto submit(Job job) -> QFuture<std::invoke_result_t<Job>>
+    {
+        using Result = std::invoke_result_t<Job>;
+
+        auto promise = std::make_shared<QPromise<Result>>();
+        QFuture<Result> future = promise->future();
+        promise->start();
+
+        QMetaObject::invokeMethod(m_context.get(), [promise, job = std::move(job)]() mutable {
+            promise->addResult(job());
+            promise->finish();
+        }, Qt::QueuedConnection);
+
+        return future;
+    }
+
+private:
+    std::unique_ptr<QThread> m_thread;
+    std::unique_ptr<QObject> m_context;     // Живёт в m_thread, принимает задачи
+};
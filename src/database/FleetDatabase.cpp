@@ -1,8 +1,110 @@
 #include "FleetDatabase.h"
+#include "SchemaMigrations.h"
+#include "../models/PerformanceLog.h"
 #include <QSqlQuery>
 #include <QSqlError>
+#include <QSqlRecord>
 #include <QVariant>
+#include <QElapsedTimer>
+#include <QHash>
+#include <QRegularExpression>
 #include <QDebug>
+#include <algorithm>
+#include <limits>
+
+namespace {
+
+const QString kInsertMachineSql = R"(
+    INSERT INTO machines (name, type, serial_number, year_of_manufacture, status, cost, currency, project_id, assigned_date, mileage, next_maintenance_date, purchase_date, warranty_period)
+    VALUES (?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?)
+)";
+
+const QString kUpdateMachineSql = R"(
+    UPDATE machines
+    SET name = ?, type = ?, serial_number = ?, year_of_manufacture = ?,
+        status = ?, cost = ?, currency = ?, project_id = ?, assigned_date = ?,
+        mileage = ?, next_maintenance_date = ?, purchase_date = ?, warranty_period = ?
+    WHERE id = ?
+)";
+
+const QString kDeleteMachineSql = "DELETE FROM machines WHERE id = ?";
+
+// Техника вместе с названием проекта: название хранится только в projects
+const QString kSelectMachinesSql = R"(
+    SELECT m.*, p.name AS project_name
+    FROM machines m
+    LEFT JOIN projects p ON p.id = m.project_id
+)";
+
+const QString kSelectMachineByIdSql = kSelectMachinesSql + "WHERE m.id = ?";
+
+const QString kSelectMachinesPageSql = kSelectMachinesSql + "WHERE m.id > ? ORDER BY m.id LIMIT ?";
+
+// Порядок по rowid индекса FTS5 отдаётся без сортировки, LIMIT останавливает поиск
+const QString kSearchMachinesSql = R"(
+    SELECT m.*, p.name AS project_name
+    FROM machines_fts f
+    JOIN machines m ON m.id = f.rowid
+    LEFT JOIN projects p ON p.id = m.project_id
+    WHERE machines_fts MATCH ?
+    ORDER BY f.rowid
+    LIMIT ?
+)";
+
+// Запрос FTS5 из строки поиска: каждое слово - фраза-префикс ("слово"*),
+// кавычки внутри слова удваиваются, поэтому спецсимволы FTS5 не действуют
+QString ftsPrefixQuery(const QString& text)
+{
+    QStringList terms;
+    for (const QString& word : text.split(' ', Qt::SkipEmptyParts)) {
+        QString escaped = word;
+        escaped.replace('"', "\"\"");
+        terms.append('"' + escaped + "\"*");
+    }
+    return terms.join(' ');
+}
+
+// Наличие индекса machines_fts, которым может пользоваться эта сборка SQLite
+const QString kFullTextIndexSql = R"(
+    SELECT sqlite_compileoption_used('ENABLE_FTS5')
+       AND EXISTS (SELECT 1 FROM sqlite_master WHERE type = 'table' AND name = 'machines_fts')
+)";
+
+// Слова строки поиска и полей по правилам токенизатора unicode61
+QStringList searchWords(const QString& text)
+{
+    static const QRegularExpression separators(R"([^\w]+)", QRegularExpression::UseUnicodePropertiesOption);
+    return text.split(separators, Qt::SkipEmptyParts);
+}
+
+const QString kSetCurrencyRateSql = R"(
+    INSERT OR REPLACE INTO currency_rates (from_currency, to_currency, rate)
+    VALUES (?, ?, ?)
+)";
+
+// Пакеты крупнее этого порога уведомляют подписчиков одним machinesReset
+constexpr int kBatchRowEventLimit = 1000;
+
+const QString kSerialNumberExistsSql = "SELECT 1 FROM machines WHERE serial_number = ? AND id <> ? LIMIT 1";
+
+// Размер пачки номеров в existingSerialNumbers (ниже лимита параметров SQLite)
+constexpr int kSerialNumberChunkSize = 500;
+
+QString serialNumbersInSql(int count)
+{
+    QStringList placeholders(count, "?");
+    return QString("SELECT serial_number FROM machines WHERE serial_number IN (%1)").arg(placeholders.join(','));
+}
+
+const QString kSelectCurrencyRateSql = "SELECT rate FROM currency_rates WHERE from_currency = ? AND to_currency = ?";
+
+// Даты хранятся номером юлианского дня (QDate::toJulianDay), пустая дата - NULL
+QVariant dayNumber(const QDate& date)
+{
+    return date.isValid() ? QVariant(date.toJulianDay()) : QVariant();
+}
+
+} // namespace
 
 FleetDatabase& FleetDatabase::instance()
 {
@@ -10,120 +112,146 @@ FleetDatabase& FleetDatabase::instance()
     return instance;
 }
 
-FleetDatabase::FleetDatabase(): m_initialized(false) {}
+FleetDatabase::FleetDatabase(): m_initialized(false)
+{
+    qRegisterMetaType<ChangeEvent>();
+    
+    for (auto& rate : m_exchangeRates)
+        rate.store(1.0, std::memory_order_relaxed);
+}
 
 FleetDatabase::~FleetDatabase()
 {
     close();
 }
 
-bool FleetDatabase::initialize(const QString& dbPath, bool createSample)
+bool FleetDatabase::initialize(const QString& dbPath, bool createSample, const StorageProfile& profile)
 {
+    const QMutexLocker locker(&m_lifecycleMutex);
     if (m_initialized) return true;
 
-    m_database = QSqlDatabase::addDatabase("QSQLITE");
-    m_database.setDatabaseName(dbPath);
+    // Одинаковые настройки для соединения каждого потока
+    m_storageProfile = profile;
+    m_pool.configure(dbPath, profile.pragmas());
     
-    if (!m_database.open()) {
-        qWarning() << "Не удалось открыть базу данных:" << m_database.lastError().text();
+    if (!m_pool.acquire()) {
+        qWarning() << "Не удалось открыть базу данных:" << dbPath;
         return false;
     }
     
-    if (!createTables()) {
-        qWarning() << "Не удалось создать таблицы";
+    if (!migrateSchema()) {
+        qWarning() << "Не удалось обновить схему базы данных";
         return false;
     }
     
+    QSqlQuery fullText(kFullTextIndexSql, database());
+    m_fullTextSearch = fullText.next() && fullText.value(0).toBool();
+    if (!m_fullTextSearch)
+        qWarning() << "Полнотекстовый индекс недоступен (SQLite без FTS5) - поиск просматривает таблицу";
+    
+    loadCurrencyRates();
+    
     if (createSample) {
         // Проверяем, пустая ли база, перед созданием демо-данных
-        QSqlQuery query("SELECT COUNT(*) FROM machines");
+        QSqlQuery query("SELECT COUNT(*) FROM machines", database());
         if (query.next() && query.value(0).toInt() == 0)
             createSampleData();
     }
+    
+    seedCounters();
+    
+    // Фоновый поток получит своё соединение из пула при первом запросе
+    m_worker.start();
 
     m_initialized = true;
-    qDebug() << "База данных успешно инициализирована:" << dbPath;
+    qDebug() << "База данных успешно инициализирована:" << dbPath << "профиль" << profile.id;
     return true;
 }
 
-void FleetDatabase::close()
+StorageProfile FleetDatabase::storageProfile()
 {
-    if (m_database.isOpen()) {
-        m_database.close();
-    }
-    m_initialized = false;
+    const QMutexLocker locker(&m_lifecycleMutex);
+    return m_storageProfile;
 }
 
-bool FleetDatabase::createTables()
-{
-    QSqlQuery query;
-    
-    // Создаём таблицу техники
-    const QString createMachinesTable = R"(
-        CREATE TABLE IF NOT EXISTS machines (
-            id INTEGER PRIMARY KEY AUTOINCREMENT,
-            name TEXT NOT NULL,
-            type TEXT NOT NULL,
-            serial_number TEXT UNIQUE NOT NULL,
-            year_of_manufacture INTEGER NOT NULL,
-            status TEXT NOT NULL,
-            cost REAL NOT NULL,
-            currency TEXT NOT NULL DEFAULT 'RUB',
-            current_project TEXT,
-            assigned_date TEXT,
-            mileage INTEGER DEFAULT 0,
-            next_maintenance_date TEXT,
-            purchase_date TEXT,
-            warranty_period INTEGER DEFAULT 12
-        )
-    )";
-    
-    if (!query.exec(createMachinesTable)) {
-        qWarning() << "Ошибка создания таблицы machines:" << query.lastError().text();
-        return false;
-    }
+bool FleetDatabase::setStorageProfile(const StorageProfile& profile)
+{
+    const QMutexLocker locker(&m_lifecycleMutex);
     
-    // Создаём таблицу проектов
-    const QString createProjectsTable = R"(
-        CREATE TABLE IF NOT EXISTS projects (
-            id INTEGER PRIMARY KEY AUTOINCREMENT,
-            name TEXT NOT NULL UNIQUE,
-            description TEXT
-        )
-    )";
+    if (!m_initialized) {
+        m_storageProfile = profile;
+        m_pool.setPragmas(profile.pragmas());
+        return true;
+    }
     
-    if (!query.exec(createProjectsTable)) {
-        qWarning() << "Ошибка создания таблицы projects:" << query.lastError().text();
-        return false;
+    if (reopenConnections(profile)) {
+        m_storageProfile = profile;
+        qDebug() << "Профиль хранения:" << profile.id;
+        return true;
     }
     
-    // Создаём таблицу курсов валют
-    const QString createCurrencyRatesTable = R"(
-        CREATE TABLE IF NOT EXISTS currency_rates (
-            id INTEGER PRIMARY KEY AUTOINCREMENT,
-            from_currency TEXT NOT NULL,
-            to_currency TEXT NOT NULL,
-            rate REAL NOT NULL,
-            UNIQUE(from_currency, to_currency)
-        )
-    )";
+    // Возвращаем прежний профиль, чтобы база осталась в рабочем режиме
+    qWarning() << "Профиль хранения" << profile.id << "не применён, действует" << m_storageProfile.id;
+    reopenConnections(m_storageProfile);
+    return false;
+}
+
+bool FleetDatabase::reopenConnections(const StorageProfile& profile)
+{
+    // SQLite не выходит из WAL, пока открыто другое соединение, поэтому
+    // соединения обоих потоков закрываются, и режим журнала меняет
+    // соединение главного потока, открытое первым.
+    // Соединение фонового потока закрывается в нём же после уже
+    // поставленных задач; главный поток ждёт и новых задач не ставит
+    const bool workerRunning = m_worker.thread()->isRunning();
+    if (workerRunning)
+        m_worker.submit([this] { m_pool.release(); return true; }).waitForFinished();
+    m_pool.release();
     
-    if (!query.exec(createCurrencyRatesTable)) {
-        qWarning() << "Ошибка создания таблицы currency_rates:" << query.lastError().text();
-        return false;
+    m_pool.setPragmas(profile.pragmas());
+    if (!m_pool.acquire()) return false;
+    
+    // Фоновый поток открывает соединение сразу, чтобы ошибка стала видна здесь
+    if (workerRunning)
+        return m_worker.submit([this] { return m_pool.acquire() != nullptr; }).result();
+    return true;
+}
+
+void FleetDatabase::close()
+{
+    const QMutexLocker locker(&m_lifecycleMutex);
+    
+    if (m_worker.thread()->isRunning()) {
+        // Соединение фонового потока закрывается в нём же
+        m_worker.submit([this] { m_pool.release(); return true; }).waitForFinished();
+        m_worker.stop();
     }
     
+    m_pool.closeAll();
+    m_initialized = false;
+}
+
+QSqlDatabase FleetDatabase::database()
+{
+    ConnectionPool::Connection* connection = m_pool.acquire();
+    return connection ? connection->database : QSqlDatabase();
+}
+
+bool FleetDatabase::migrateSchema()
+{
+    if (!SchemaMigrations::migrate(database())) return false;
+    
     // Инициализируем курсы валют по умолчанию
     initializeDefaultCurrencyRates();
     
-    qDebug() << "Таблицы успешно созданы";
+    qDebug() << "Схема базы данных актуальна, версия" << SchemaMigrations::latestVersion();
     return true;
 }
 
 void FleetDatabase::initializeDefaultCurrencyRates()
 {
     // Проверяем, есть ли уже курсы в базе
-    QSqlQuery checkQuery("SELECT COUNT(*) FROM currency_rates");
+    QSqlQuery checkQuery("SELECT COUNT(*) FROM currency_rates", database());
     if (checkQuery.next() && checkQuery.value(0).toInt() > 0) {
         qDebug() << "Курсы валют готовы к использованию из БД";
         return;
@@ -152,13 +280,12 @@ void FleetDatabase::createSampleData()
     // Добавляем технику
     const auto machine1 = std::make_shared<Machine>("Экскаватор CAT 320D", "Экскаватор", "CAT320D-2019-0847", 2019, Money(1000, Currency::USD));
     machine1->setStatus(MachineStatus::OnSite);
-    machine1->setCurrentProject("ЖК «Солнечный»");
+    machine1->setProjectId(project1->getId());
     machine1->setAssignedDate(QDate(2026, 1, 20));
     machine1->setMileage(4250);
     machine1->setNextMaintenanceDate(QDate(2026, 3, 20));
     machine1->setPurchaseDate(QDate(2019, 3, 15));
     machine1->setWarrantyPeriod(24);
-    addMachine(machine1);
 
     const auto machine2 = std::make_shared<Machine>("Бульдозер Komatsu D65", "Бульдозер", "KOM-D65-2020-1123", 2020, Money(12300000, Currency::RUB));
     machine2->setStatus(MachineStatus::Available);
@@ -166,16 +293,14 @@ void FleetDatabase::createSampleData()
     machine2->setNextMaintenanceDate(QDate(2026, 4, 10));
     machine2->setPurchaseDate(QDate(2020, 5, 22));
     machine2->setWarrantyPeriod(24);
-    addMachine(machine2);
 
     const auto machine3 = std::make_shared<Machine>("Кран башенный КБ-403", "Кран", "KB403-2018-0291", 2018, Money(15700000, Currency::RUB));
     machine3->setStatus(MachineStatus::OnSite);
-    machine3->setCurrentProject("БЦ «Меридиан»");
+    machine3->setProjectId(project2->getId());
     machine3->setMileage(1850);
     machine3->setNextMaintenanceDate(QDate(2026, 2, 28));
     machine3->setPurchaseDate(QDate(2018, 7, 10));
     machine3->setWarrantyPeriod(36);
-    addMachine(machine3);
 
     const auto machine4 = std::make_shared<Machine>("Автокран Liebherr LTM 1050", "Автокран", "LTM1050-2021-0055", 2021, Money(22100000, Currency::RUB));
     machine4->setStatus(MachineStatus::InRepair);
@@ -183,7 +308,6 @@ void FleetDatabase::createSampleData()
     machine4->setNextMaintenanceDate(QDate(2026, 1, 25));
     machine4->setPurchaseDate(QDate(2021, 9, 12));
     machine4->setWarrantyPeriod(24);
-    addMachine(machine4);
 
     const auto machine5 = std::make_shared<Machine>("Погрузчик JCB 531-70", "Погрузчик", "JCB531-2019-0782", 2019, Money(4200000, Currency::RUB));
     machine5->setStatus(MachineStatus::Available);
@@ -191,16 +315,14 @@ void FleetDatabase::createSampleData()
     machine5->setNextMaintenanceDate(QDate(2026, 3, 15));
     machine5->setPurchaseDate(QDate(2019, 11, 8));
     machine5->setWarrantyPeriod(24);
-    addMachine(machine5);
 
     const auto machine6 = std::make_shared<Machine>("Экскаватор-погрузчик JCB 3CX", "Экскаватор-погрузчик", "JCB3CX-2020-0394", 2020, Money(5800000, Currency::RUB));
     machine6->setStatus(MachineStatus::OnSite);
-    machine6->setCurrentProject("ЖК «Солнечный»");
+    machine6->setProjectId(project1->getId());
     machine6->setMileage(2890);
     machine6->setNextMaintenanceDate(QDate(2026, 4, 5));
     machine6->setPurchaseDate(QDate(2020, 2, 18));
     machine6->setWarrantyPeriod(24);
-    addMachine(machine6);
 
     const auto machine7 = std::make_shared<Machine>("Самосвал КАМАЗ-6520", "Самосвал", "KMZ6520-2017-1847", 2017, Money(3900000, Currency::RUB));
     machine7->setStatus(MachineStatus::Available);
@@ -208,16 +330,14 @@ void FleetDatabase::createSampleData()
     machine7->setNextMaintenanceDate(QDate(2026, 2, 10));
     machine7->setPurchaseDate(QDate(2017, 6, 20));
     machine7->setWarrantyPeriod(36);
-    addMachine(machine7);
 
     const auto machine8 = std::make_shared<Machine>("Бетономешалка MAN TGS", "Бетономешалка", "MAN-TGS-2019-0621", 2019, Money(7200000, Currency::RUB));
     machine8->setStatus(MachineStatus::OnSite);
-    machine8->setCurrentProject("Школа №15");
+    machine8->setProjectId(project3->getId());
     machine8->setMileage(12450);
     machine8->setNextMaintenanceDate(QDate(2026, 3, 30));
     machine8->setPurchaseDate(QDate(2019, 8, 5));
     machine8->setWarrantyPeriod(24);
-    addMachine(machine8);
 
     const auto machine9 = std::make_shared<Machine>("Каток BOMAG BW 213", "Каток", "BOMAG213-2018-0183", 2018, Money(6100000, Currency::RUB));
     machine9->setStatus(MachineStatus::InRepair);
@@ -225,7 +345,6 @@ void FleetDatabase::createSampleData()
     machine9->setNextMaintenanceDate(QDate(2026, 1, 20));
     machine9->setPurchaseDate(QDate(2018, 4, 12));
     machine9->setWarrantyPeriod(24);
-    addMachine(machine9);
 
     const auto machine10 = std::make_shared<Machine>("Грейдер ДЗ-98", "Грейдер", "DZ98-2016-0095", 2016, Money(2800000, Currency::RUB));
     machine10->setStatus(MachineStatus::Decommissioned);
@@ -233,7 +352,6 @@ void FleetDatabase::createSampleData()
     machine10->setNextMaintenanceDate(QDate(2025, 12, 15));
     machine10->setPurchaseDate(QDate(2016, 9, 3));
     machine10->setWarrantyPeriod(36);
-    addMachine(machine10);
 
     const auto machine11 = std::make_shared<Machine>("Виброплита Wacker Neuson", "Виброплита", "WN-VP-2022-0012", 2022, Money(320000, Currency::RUB));
     machine11->setStatus(MachineStatus::Available);
@@ -241,16 +359,18 @@ void FleetDatabase::createSampleData()
     machine11->setNextMaintenanceDate(QDate(2026, 5, 15));
     machine11->setPurchaseDate(QDate(2022, 1, 25));
     machine11->setWarrantyPeriod(12);
-    addMachine(machine11);
 
     const auto machine12 = std::make_shared<Machine>("Компрессор Atlas Copco", "Компрессор", "AC-XAS-2021-0487", 2021, Money(890000, Currency::RUB));
     machine12->setStatus(MachineStatus::OnSite);
-    machine12->setCurrentProject("БЦ «Меридиан»");
+    machine12->setProjectId(project2->getId());
     machine12->setMileage(2340);
     machine12->setNextMaintenanceDate(QDate(2026, 4, 20));
     machine12->setPurchaseDate(QDate(2021, 6, 10));
     machine12->setWarrantyPeriod(12);
-    addMachine(machine12);
+    
+    // Вся техника добавляется одной транзакцией
+    addMachines({machine1, machine2, machine3, machine4, machine5, machine6,
+                 machine7, machine8, machine9, machine10, machine11, machine12});
     
     qDebug() << "Тестовые данные созданы";
 }
@@ -259,294 +379,558 @@ void FleetDatabase::createSampleData()
 
 bool FleetDatabase::addMachine(const MachinePtr& machine)
 {
-    QSqlQuery query;
-    query.prepare(R"(
-        INSERT INTO machines (name, type, serial_number, year_of_manufacture, status, cost, currency, current_project, assigned_date, mileage, next_maintenance_date, purchase_date, warranty_period)
-        VALUES (?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?)
-    )");
-    
-    query.addBindValue(machine->getName());
-    query.addBindValue(machine->getType());
-    query.addBindValue(machine->getSerialNumber());
-    query.addBindValue(machine->getYearOfManufacture());
-    query.addBindValue(Machine::statusToString(machine->getStatus()));
-    query.addBindValue(machine->getCost().getAmount());
-    query.addBindValue(Money::getCurrencyName(machine->getCost().getCurrency()));
-    query.addBindValue(machine->getCurrentProject());
-    query.addBindValue(machine->getAssignedDate().isValid() ? machine->getAssignedDate().toString(Qt::ISODate) : QVariant());
-    query.addBindValue(machine->getMileage());
-    query.addBindValue(machine->getNextMaintenanceDate().isValid() ? machine->getNextMaintenanceDate().toString(Qt::ISODate) : QVariant());
-    query.addBindValue(machine->getPurchaseDate().isValid() ? machine->getPurchaseDate().toString(Qt::ISODate) : QVariant());
-    query.addBindValue(machine->getWarrantyPeriod());
-    
-    if (!query.exec()) {
-        qWarning() << "Ошибка добавления техники:" << query.lastError().text();
-        return false;
-    }
-    
-    machine->setId(query.lastInsertId().toInt());
-    return true;
+    return applyBatch({{MachineOperation::Kind::Insert, machine}});
 }
 
 bool FleetDatabase::updateMachine(MachinePtr machine)
 {
-    QSqlQuery query;
-    query.prepare(R"(
-        UPDATE machines
-        SET name = ?, type = ?, serial_number = ?, year_of_manufacture = ?,
-            status = ?, cost = ?, currency = ?, current_project = ?, assigned_date = ?,
-            mileage = ?, next_maintenance_date = ?, purchase_date = ?, warranty_period = ?
-        WHERE id = ?
-    )");
+    return applyBatch({{MachineOperation::Kind::Update, std::move(machine)}});
+}
+
+bool FleetDatabase::deleteMachine(int machineId)
+{
+    return applyBatch({{MachineOperation::Kind::Delete, nullptr, machineId}});
+}
+
+bool FleetDatabase::addMachines(const QVector<MachinePtr>& machines)
+{
+    QVector<MachineOperation> operations;
+    operations.reserve(machines.size());
+    for (const MachinePtr& machine : machines)
+        operations.append({MachineOperation::Kind::Insert, machine});
+    return applyBatch(operations);
+}
+
+bool FleetDatabase::updateMachines(const QVector<MachinePtr>& machines)
+{
+    QVector<MachineOperation> operations;
+    operations.reserve(machines.size());
+    for (const MachinePtr& machine : machines)
+        operations.append({MachineOperation::Kind::Update, machine});
+    return applyBatch(operations);
+}
+
+bool FleetDatabase::applyBatch(const QVector<MachineOperation>& operations)
+{
+    if (operations.isEmpty()) return true;
     
-    query.addBindValue(machine->getName());
-    query.addBindValue(machine->getType());
-    query.addBindValue(machine->getSerialNumber());
-    query.addBindValue(machine->getYearOfManufacture());
-    query.addBindValue(Machine::statusToString(machine->getStatus()));
-    query.addBindValue(machine->getCost().getAmount());
-    query.addBindValue(Money::getCurrencyName(machine->getCost().getCurrency()));
-    query.addBindValue(machine->getCurrentProject());
-    query.addBindValue(machine->getAssignedDate().isValid() ? machine->getAssignedDate().toString(Qt::ISODate) : QVariant());
-    query.addBindValue(machine->getMileage());
-    query.addBindValue(machine->getNextMaintenanceDate().isValid() ? machine->getNextMaintenanceDate().toString(Qt::ISODate) : QVariant());
-    query.addBindValue(machine->getPurchaseDate().isValid() ? machine->getPurchaseDate().toString(Qt::ISODate) : QVariant());
-    query.addBindValue(machine->getWarrantyPeriod());
-    query.addBindValue(machine->getId());
+    const bool notifyRows = operations.size() <= kBatchRowEventLimit;
     
-    if (!query.exec()) {
-        qWarning() << "Ошибка обновления техники:" << query.lastError().text();
+    QSqlDatabase db = database();
+    if (!beginWriteTransaction(db)) return false;
+    
+    // Прежние версии читаются внутри транзакции: пока она держит блокировку
+    // записи, другой писатель не изменит эти строки. Нужны для уведомлений и
+    // счётчиков; крупный пакет пересчитывает счётчики целиком
+    QHash<int, MachinePtr> before;
+    if (notifyRows) {
+        for (const MachineOperation& operation : operations) {
+            if (operation.kind == MachineOperation::Kind::Insert) continue;
+            const int id = operation.kind == MachineOperation::Kind::Delete ? operation.machineId
+                                                                              : operation.machine->getId();
+            if (!before.contains(id)) before.insert(id, getMachineById(id));
+        }
+    }
+    
+    QVector<ChangeEvent> events;
+    if (notifyRows) events.reserve(operations.size());
+    
+    // Прежние ID добавленных объектов - для восстановления при откате
+    QVector<QPair<MachinePtr, int>> assignedIds;
+    // Изменила ли операция строку (UPDATE и DELETE удалённой записи - нет)
+    QVector<bool> applied;
+    applied.reserve(operations.size());
+    bool success = true;
+    
+    for (const MachineOperation& operation : operations) {
+        QSqlQuery* query = nullptr;
+        switch (operation.kind) {
+        case MachineOperation::Kind::Insert:
+            query = preparedQuery(kInsertMachineSql);
+            if (!query) break;
+            bindMachineFields(*query, *operation.machine);
+            break;
+        case MachineOperation::Kind::Update:
+            query = preparedQuery(kUpdateMachineSql);
+            if (!query) break;
+            bindMachineFields(*query, *operation.machine);
+            query->bindValue(13, operation.machine->getId());
+            break;
+        case MachineOperation::Kind::Delete:
+            query = preparedQuery(kDeleteMachineSql);
+            if (!query) break;
+            query->bindValue(0, operation.machineId);
+            break;
+        }
+        
+        if (!query) {
+            success = false;
+            break;
+        }
+        
+        if (!query->exec()) {
+            qWarning() << "Ошибка операции с техникой:" << query->lastError().text();
+            success = false;
+            break;
+        }
+        
+        const bool changed = query->numRowsAffected() > 0;
+        applied.append(changed);
+        
+        switch (operation.kind) {
+        case MachineOperation::Kind::Insert:
+            assignedIds.append({operation.machine, operation.machine->getId()});
+            operation.machine->setId(query->lastInsertId().toInt());
+            if (notifyRows)
+                events.append({ChangeEvent::Entity::Machine, ChangeEvent::Operation::Inserted,
+                               operation.machine->getId(), ChangeEvent::AllFields});
+            break;
+        case MachineOperation::Kind::Update:
+            // Запись могли удалить до начала транзакции - уведомлять не о чем
+            if (notifyRows && changed) {
+                const MachinePtr& previous = before.value(operation.machine->getId());
+                const ChangeEvent::Fields fields = previous ? changedMachineFields(*previous, *operation.machine)
+                                                            : ChangeEvent::Fields(ChangeEvent::AllFields);
+                if (fields)
+                    events.append({ChangeEvent::Entity::Machine, ChangeEvent::Operation::Updated,
+                                   operation.machine->getId(), fields});
+            }
+            break;
+        case MachineOperation::Kind::Delete:
+            if (notifyRows && changed)
+                events.append({ChangeEvent::Entity::Machine, ChangeEvent::Operation::Deleted,
+                               operation.machineId, ChangeEvent::AllFields});
+            break;
+        }
+    }
+    
+    const auto restoreIds = [&assignedIds] {
+        for (const auto& [machine, previousId] : assignedIds)
+            machine->setId(previousId);
+    };
+    
+    if (!success) {
+        db.rollback();
+        restoreIds();
         return false;
     }
     
+    // Счётчики меняются до фиксации, пока транзакция держит блокировку
+    // записи: изменения разных писателей доходят до них по одному
+    if (notifyRows) {
+        // Операции применяются к счётчикам по порядку: текущая версия каждой
+        // записи хранится в before и сменяется по мере выполнения пакета
+        for (qsizetype i = 0; i < operations.size(); ++i) {
+            if (!applied[i]) continue;  // Строка не изменилась - счётчики тоже
+            const MachineOperation& operation = operations[i];
+            switch (operation.kind) {
+            case MachineOperation::Kind::Insert:
+                adjustCounters(*operation.machine, +1);
+                before[operation.machine->getId()] = operation.machine;
+                break;
+            case MachineOperation::Kind::Update: {
+                MachinePtr& current = before[operation.machine->getId()];
+                if (!current) break;
+                adjustCounters(*current, -1);
+                adjustCounters(*operation.machine, +1);
+                current = operation.machine;
+                break;
+            }
+            case MachineOperation::Kind::Delete: {
+                MachinePtr& current = before[operation.machineId];
+                if (!current) break;
+                adjustCounters(*current, -1);
+                current.reset();
+                break;
+            }
+            }
+        }
+        verifyCounters();
+    } else {
+        seedCounters();
+    }
+    
+    if (!db.commit()) {
+        qWarning() << "Не удалось зафиксировать транзакцию:" << db.lastError().text();
+        db.rollback();
+        restoreIds();
+        seedCounters(); // Счётчики уже учли откаченные изменения
+        return false;
+    }
+    
+    if (operations.size() > 1)
+        qDebug() << "Пакет операций с техникой выполнен:" << operations.size();
+    
+    // Подписчики читают базу - уведомляем после фиксации
+    if (!notifyRows) {
+        emit machinesReset();
+        return true;
+    }
+    
+    for (const ChangeEvent& event : events)
+        emit machineChanged(event);
     return true;
 }
 
-bool FleetDatabase::deleteMachine(int machineId)
+bool FleetDatabase::beginWriteTransaction(const QSqlDatabase& db)
 {
-    QSqlQuery query;
-    query.prepare("DELETE FROM machines WHERE id = ?");
-    query.addBindValue(machineId);
-    
-    if (!query.exec()) {
-        qWarning() << "Ошибка удаления техники:" << query.lastError().text();
+    // IMMEDIATE берёт блокировку записи сразу: другой писатель ждёт её
+    // через busy_timeout, а не получает SQLITE_BUSY посреди транзакции
+    QSqlQuery begin(db);
+    if (!begin.exec("BEGIN IMMEDIATE")) {
+        qWarning() << "Не удалось начать транзакцию:" << begin.lastError().text();
         return false;
     }
-    
     return true;
 }
 
+void FleetDatabase::bindMachineFields(QSqlQuery& query, const Machine& machine)
+{
+    query.bindValue(0, machine.getName());
+    query.bindValue(1, machine.getType());
+    query.bindValue(2, machine.getSerialNumber());
+    query.bindValue(3, machine.getYearOfManufacture());
+    query.bindValue(4, Machine::statusToCode(machine.getStatus()));
+    query.bindValue(5, machine.getCost().getAmount());
+    query.bindValue(6, Money::getCurrencyName(machine.getCost().getCurrency()));
+    query.bindValue(7, machine.getProjectId() > 0 ? QVariant(machine.getProjectId()) : QVariant());
+    query.bindValue(8, dayNumber(machine.getAssignedDate()));
+    query.bindValue(9, machine.getMileage());
+    query.bindValue(10, dayNumber(machine.getNextMaintenanceDate()));
+    query.bindValue(11, dayNumber(machine.getPurchaseDate()));
+    query.bindValue(12, machine.getWarrantyPeriod());
+}
+
+ChangeEvent::Fields FleetDatabase::changedMachineFields(const Machine& before, const Machine& after)
+{
+    ChangeEvent::Fields fields;
+    if (before.getName() != after.getName()) fields |= ChangeEvent::Name;
+    if (before.getType() != after.getType()) fields |= ChangeEvent::Type;
+    if (before.getSerialNumber() != after.getSerialNumber()) fields |= ChangeEvent::SerialNumber;
+    if (before.getYearOfManufacture() != after.getYearOfManufacture()) fields |= ChangeEvent::YearOfManufacture;
+    if (before.getStatus() != after.getStatus()) fields |= ChangeEvent::Status;
+    if (before.getCost().getAmount() != after.getCost().getAmount()
+        || before.getCost().getCurrency() != after.getCost().getCurrency()) fields |= ChangeEvent::Cost;
+    if (before.getProjectId() != after.getProjectId()) fields |= ChangeEvent::CurrentProject;
+    if (before.getAssignedDate() != after.getAssignedDate()) fields |= ChangeEvent::AssignedDate;
+    if (before.getMileage() != after.getMileage()) fields |= ChangeEvent::Mileage;
+    if (before.getNextMaintenanceDate() != after.getNextMaintenanceDate()) fields |= ChangeEvent::NextMaintenanceDate;
+    if (before.getPurchaseDate() != after.getPurchaseDate()) fields |= ChangeEvent::PurchaseDate;
+    if (before.getWarrantyPeriod() != after.getWarrantyPeriod()) fields |= ChangeEvent::WarrantyPeriod;
+    return fields;
+}
+
 QVector<MachinePtr> FleetDatabase::getAllMachines()
 {
-    QVector<MachinePtr> machines;
-    QSqlQuery query("SELECT * FROM machines ORDER BY id");
+    QElapsedTimer timer;
+    timer.start();
+
+    QSqlQuery query(database());
+    query.setForwardOnly(true);
+    if (!query.exec(kSelectMachinesSql + "ORDER BY m.id")) {
+        qWarning() << "Ошибка получения техники:" << query.lastError().text();
+        return {};
+    }
+
+    QVector<MachinePtr> machines = readMachines(query);
+
+    const qint64 elapsed = timer.nsecsElapsed();
+    if (elapsed > 0 && !machines.isEmpty())
+        qCDebug(lcPerformance) << "Загружено техники:" << machines.size() << "за" << elapsed / 1000000.0 << "мс ("
+                               << qRound64(machines.size() * 1e9 / elapsed) << "строк/с)";
+
+    return machines;
+}
+
+QVector<MachinePtr> FleetDatabase::getMachinesPage(int afterId, int limit,
+                                                  const SqlCondition& condition)
+{
+    // Условие фильтра встраивается в текст запроса, значения - параметрами,
+    // поэтому подготовленный запрос кэшируется на каждую форму условия
+    const QString sql = condition.where.isEmpty()
+        ? kSelectMachinesPageSql
+        : kSelectMachinesSql + "WHERE m.id > ? AND (" + condition.where + ") ORDER BY m.id LIMIT ?";
+    QSqlQuery* query = preparedQuery(sql);
+    if (!query) return {};
     
-    while (query.next()) {
-        auto machine = std::make_shared<Machine>();
-        machine->setId(query.value("id").toInt());
-        machine->setName(query.value("name").toString());
-        machine->setType(query.value("type").toString());
-        machine->setSerialNumber(query.value("serial_number").toString());
-        machine->setYearOfManufacture(query.value("year_of_manufacture").toInt());
-        machine->setStatus(Machine::stringToStatus(query.value("status").toString()));
-        
-        // Загружаем стоимость с валютой
-        double amount = query.value("cost").toDouble();
-        QString currencyStr = query.value("currency").toString();
-        Currency currency = Money::currencyFromString(currencyStr);
-        machine->setCost(Money(amount, currency));
-        
-        machine->setCurrentProject(query.value("current_project").toString());
-        
-        QString dateStr = query.value("assigned_date").toString();
-        if (!dateStr.isEmpty()) {
-            machine->setAssignedDate(QDate::fromString(dateStr, Qt::ISODate));
-        }
-        
-        // Загружаем новые поля
-        machine->setMileage(query.value("mileage").toInt());
-        
-        QString nextMaintenanceDateStr = query.value("next_maintenance_date").toString();
-        if (!nextMaintenanceDateStr.isEmpty()) {
-            machine->setNextMaintenanceDate(QDate::fromString(nextMaintenanceDateStr, Qt::ISODate));
-        }
-        
-        QString purchaseDateStr = query.value("purchase_date").toString();
-        if (!purchaseDateStr.isEmpty()) {
-            machine->setPurchaseDate(QDate::fromString(purchaseDateStr, Qt::ISODate));
-        }
-        
-        machine->setWarrantyPeriod(query.value("warranty_period").toInt());
-        
-        machines.append(machine);
+    int position = 0;
+    query->bindValue(position++, afterId);
+    for (const QVariant& value : condition.bindings)
+        query->bindValue(position++, value);
+    query->bindValue(position, limit);
+    
+    if (!query->exec()) {
+        qWarning() << "Ошибка получения страницы техники:" << query->lastError().text();
+        return {};
     }
     
+    QVector<MachinePtr> machines = readMachines(*query);
+    query->finish();
     return machines;
 }
 
 MachinePtr FleetDatabase::getMachineById(int machineId)
 {
-    QSqlQuery query;
-    query.prepare("SELECT * FROM machines WHERE id = ?");
-    query.addBindValue(machineId);
+    QSqlQuery* query = preparedQuery(kSelectMachineByIdSql);
+    if (!query) return nullptr;
     
-    if (!query.exec() || !query.next()) {
+    query->bindValue(0, machineId);
+    
+    if (!query->exec() || !query->next()) {
+        query->finish();
         return nullptr;
     }
     
-    auto machine = std::make_shared<Machine>();
-    machine->setId(query.value("id").toInt());
-    machine->setName(query.value("name").toString());
-    machine->setType(query.value("type").toString());
-    machine->setSerialNumber(query.value("serial_number").toString());
-    machine->setYearOfManufacture(query.value("year_of_manufacture").toInt());
-    machine->setStatus(Machine::stringToStatus(query.value("status").toString()));
-    
-    // Загружаем стоимость с валютой
-    double amount = query.value("cost").toDouble();
-    QString currencyStr = query.value("currency").toString();
-    Currency currency = Money::currencyFromString(currencyStr);
-    machine->setCost(Money(amount, currency));
-    
-    machine->setCurrentProject(query.value("current_project").toString());
+    auto machine = machineFromRow(*query, MachineColumns(query->record()));
+    query->finish();
+    return machine;
+}
 
-    const QString dateStr = query.value("assigned_date").toString();
-    if (!dateStr.isEmpty()) {
-        machine->setAssignedDate(QDate::fromString(dateStr, Qt::ISODate));
+QVector<MachinePtr> FleetDatabase::getMachinesByStatus(MachineStatus status)
+{
+    QSqlQuery query(database());
+    query.setForwardOnly(true);
+    query.prepare(kSelectMachinesSql + "WHERE m.status = ? ORDER BY m.id");
+    query.addBindValue(Machine::statusToCode(status));
+    
+    if (!query.exec()) {
+        return {};
     }
     
-    // Загружаем новые поля
-    machine->setMileage(query.value("mileage").toInt());
+    return readMachines(query);
+}
+
+QVector<MachinePtr> FleetDatabase::getMachinesByProject(int projectId)
+{
+    QSqlQuery query(database());
+    query.setForwardOnly(true);
+    query.prepare(kSelectMachinesSql + "WHERE m.project_id = ? ORDER BY m.id");
+    query.addBindValue(projectId);
     
-    const QString nextMaintenanceDateStr = query.value("next_maintenance_date").toString();
-    if (!nextMaintenanceDateStr.isEmpty()) {
-        machine->setNextMaintenanceDate(QDate::fromString(nextMaintenanceDateStr, Qt::ISODate));
+    if (!query.exec()) {
+        qWarning() << "Ошибка получения техники по проекту:" << query.lastError().text();
+        return {};
     }
     
-    const QString purchaseDateStr = query.value("purchase_date").toString();
-    if (!purchaseDateStr.isEmpty()) {
-        machine->setPurchaseDate(QDate::fromString(purchaseDateStr, Qt::ISODate));
-    }
+    return readMachines(query);
+}
+
+int FleetDatabase::countMachinesOnProject(int projectId)
+{
+    QSqlQuery query(database());
+    query.prepare("SELECT COUNT(*) FROM machines WHERE project_id = ?");
+    query.addBindValue(projectId);
     
-    machine->setWarrantyPeriod(query.value("warranty_period").toInt());
+    if (!query.exec() || !query.next()) {
+        qWarning() << "Ошибка подсчёта техники на проекте:" << query.lastError().text();
+        return 0;
+    }
     
-    return machine;
+    return query.value(0).toInt();
 }
 
-QVector<MachinePtr> FleetDatabase::getMachinesByStatus(MachineStatus status)
+bool FleetDatabase::serialNumberExists(const QString& serialNumber, int excludeMachineId)
 {
-    QVector<MachinePtr> machines;
-    QSqlQuery query;
-    query.prepare("SELECT * FROM machines WHERE status = ? ORDER BY id");
-    query.addBindValue(Machine::statusToString(status));
+    QSqlQuery* query = preparedQuery(kSerialNumberExistsSql);
+    if (!query) return false;
     
-    if (!query.exec()) {
-        return machines;
+    query->bindValue(0, serialNumber);
+    query->bindValue(1, excludeMachineId);
+    
+    if (!query->exec()) {
+        qWarning() << "Ошибка проверки серийного номера:" << query->lastError().text();
+        return false;
     }
     
-    while (query.next()) {
-        auto machine = std::make_shared<Machine>();
-        machine->setId(query.value("id").toInt());
-        machine->setName(query.value("name").toString());
-        machine->setType(query.value("type").toString());
-        machine->setSerialNumber(query.value("serial_number").toString());
-        machine->setYearOfManufacture(query.value("year_of_manufacture").toInt());
-        machine->setStatus(Machine::stringToStatus(query.value("status").toString()));
-        
-        // Загружаем стоимость с валютой
-        double amount = query.value("cost").toDouble();
-        QString currencyStr = query.value("currency").toString();
-        Currency currency = Money::currencyFromString(currencyStr);
-        machine->setCost(Money(amount, currency));
-        
-        machine->setCurrentProject(query.value("current_project").toString());
+    const bool exists = query->next();
+    query->finish();
+    return exists;
+}
+
+QSet<QString> FleetDatabase::existingSerialNumbers(const QStringList& serialNumbers)
+{
+    QSet<QString> existing;
+    
+    for (qsizetype offset = 0; offset < serialNumbers.size(); offset += kSerialNumberChunkSize) {
+        const int count = static_cast<int>(std::min<qsizetype>(kSerialNumberChunkSize, serialNumbers.size() - offset));
         
-        QString dateStr = query.value("assigned_date").toString();
-        if (!dateStr.isEmpty()) {
-            machine->setAssignedDate(QDate::fromString(dateStr, Qt::ISODate));
+        // Полные пачки используют один кэшированный запрос, хвост - разовый
+        QSqlQuery tailQuery(database());
+        QSqlQuery* query = &tailQuery;
+        if (count == kSerialNumberChunkSize) {
+            query = preparedQuery(serialNumbersInSql(count));
+            if (!query) return existing;
+        } else {
+            tailQuery.setForwardOnly(true);
+            tailQuery.prepare(serialNumbersInSql(count));
         }
         
-        // Загружаем новые поля
-        machine->setMileage(query.value("mileage").toInt());
+        for (int i = 0; i < count; ++i)
+            query->bindValue(i, serialNumbers[offset + i]);
         
-        QString nextMaintenanceDateStr = query.value("next_maintenance_date").toString();
-        if (!nextMaintenanceDateStr.isEmpty()) {
-            machine->setNextMaintenanceDate(QDate::fromString(nextMaintenanceDateStr, Qt::ISODate));
+        if (!query->exec()) {
+            qWarning() << "Ошибка проверки серийных номеров:" << query->lastError().text();
+            return existing;
         }
         
-        QString purchaseDateStr = query.value("purchase_date").toString();
-        if (!purchaseDateStr.isEmpty()) {
-            machine->setPurchaseDate(QDate::fromString(purchaseDateStr, Qt::ISODate));
-        }
-        
-        machine->setWarrantyPeriod(query.value("warranty_period").toInt());
-        
-        machines.append(machine);
+        while (query->next())
+            existing.insert(query->value(0).toString());
+        query->finish();
     }
     
-    return machines;
+    return existing;
 }
 
-QVector<MachinePtr> FleetDatabase::getMachinesByProject(const QString& projectName)
+QVector<MachinePtr> FleetDatabase::getMachinesDueForMaintenance(const QDate& from, const QDate& until)
 {
-    QVector<MachinePtr> machines;
-    QSqlQuery query;
-    query.prepare("SELECT * FROM machines WHERE current_project = ? ORDER BY id");
-    query.addBindValue(projectName);
+    QSqlQuery query(database());
+    query.setForwardOnly(true);
+    
+    // Диапазон по целым номерам дней - сканирование диапазона индекса
+    query.prepare(kSelectMachinesSql + R"(
+        WHERE m.next_maintenance_date BETWEEN ? AND ?
+        ORDER BY m.next_maintenance_date
+    )");
+    query.addBindValue(from.isValid() ? from.toJulianDay() : std::numeric_limits<qint64>::min());
+    query.addBindValue(dayNumber(until));
     
     if (!query.exec()) {
-        qWarning() << "Ошибка получения техники по проекту:" << query.lastError().text();
-        return machines;
+        qWarning() << "Ошибка получения техники для обслуживания:" << query.lastError().text();
+        return {};
     }
     
-    while (query.next()) {
-        auto machine = std::make_shared<Machine>();
-        machine->setId(query.value("id").toInt());
-        machine->setName(query.value("name").toString());
-        machine->setType(query.value("type").toString());
-        machine->setSerialNumber(query.value("serial_number").toString());
-        machine->setYearOfManufacture(query.value("year_of_manufacture").toInt());
-        machine->setStatus(Machine::stringToStatus(query.value("status").toString()));
-        
-        // Загружаем стоимость с валютой
-        double amount = query.value("cost").toDouble();
-        QString currencyStr = query.value("currency").toString();
-        Currency currency = Money::currencyFromString(currencyStr);
-        machine->setCost(Money(amount, currency));
-        
-        machine->setCurrentProject(query.value("current_project").toString());
-        
-        QString dateStr = query.value("assigned_date").toString();
-        if (!dateStr.isEmpty()) {
-            machine->setAssignedDate(QDate::fromString(dateStr, Qt::ISODate));
-        }
-        
-        // Загружаем новые поля
-        machine->setMileage(query.value("mileage").toInt());
-        
-        QString nextMaintenanceDateStr = query.value("next_maintenance_date").toString();
-        if (!nextMaintenanceDateStr.isEmpty()) {
-            machine->setNextMaintenanceDate(QDate::fromString(nextMaintenanceDateStr, Qt::ISODate));
-        }
-        
-        QString purchaseDateStr = query.value("purchase_date").toString();
-        if (!purchaseDateStr.isEmpty()) {
-            machine->setPurchaseDate(QDate::fromString(purchaseDateStr, Qt::ISODate));
-        }
-        
-        machine->setWarrantyPeriod(query.value("warranty_period").toInt());
+    return readMachines(query);
+}
+
+QVector<MachinePtr> FleetDatabase::searchMachines(const QString& text, int limit)
+{
+    if (!m_fullTextSearch) return scanMachines(text, limit);
+    
+    const QString match = ftsPrefixQuery(text.simplified());
+    if (match.isEmpty()) return {};
+    
+    QSqlQuery* query = preparedQuery(kSearchMachinesSql);
+    if (!query) return {};
+    
+    query->bindValue(0, match);
+    query->bindValue(1, limit);
+    
+    if (!query->exec()) {
+        qWarning() << "Ошибка поиска техники:" << query->lastError().text();
+        return {};
+    }
+    
+    QVector<MachinePtr> machines = readMachines(*query);
+    query->finish();
+    return machines;
+}
+
+QVector<MachinePtr> FleetDatabase::scanMachines(const QString& text, int limit)
+{
+    // LIKE в SQLite не сравнивает кириллицу без учёта регистра, поэтому
+    // строки сверяются здесь по тем же правилам, что и запрос к индексу
+    const QStringList words = searchWords(text);
+    if (words.isEmpty() || limit <= 0) return {};
+    
+    QSqlQuery query(database());
+    query.setForwardOnly(true);
+    if (!query.exec(kSelectMachinesSql + "ORDER BY m.id")) {
+        qWarning() << "Ошибка поиска техники:" << query.lastError().text();
+        return {};
+    }
+    
+    const MachineColumns columns(query.record());
+    QVector<MachinePtr> machines;
+    while (machines.size() < limit && query.next()) {
+        QStringList tokens;
+        for (const int column : {columns.name, columns.type, columns.serialNumber, columns.projectName})
+            tokens += searchWords(query.value(column).toString());
         
-        machines.append(machine);
+        const bool found = std::ranges::all_of(words, [&](const QString& word) {
+            return std::ranges::any_of(tokens, [&](const QString& token) {
+                return token.startsWith(word, Qt::CaseInsensitive);
+            });
+        });
+        if (found) machines.append(machineFromRow(query, columns));
     }
+    return machines;
+}
+
+FleetDatabase::MachineColumns::MachineColumns(const QSqlRecord& record)
+    : id(record.indexOf("id"))
+    , name(record.indexOf("name"))
+    , type(record.indexOf("type"))
+    , serialNumber(record.indexOf("serial_number"))
+    , yearOfManufacture(record.indexOf("year_of_manufacture"))
+    , status(record.indexOf("status"))
+    , cost(record.indexOf("cost"))
+    , currency(record.indexOf("currency"))
+    , projectId(record.indexOf("project_id"))
+    , projectName(record.indexOf("project_name"))
+    , assignedDate(record.indexOf("assigned_date"))
+    , mileage(record.indexOf("mileage"))
+    , nextMaintenanceDate(record.indexOf("next_maintenance_date"))
+    , purchaseDate(record.indexOf("purchase_date"))
+    , warrantyPeriod(record.indexOf("warranty_period"))
+{
+}
+
+QVector<MachinePtr> FleetDatabase::readMachines(QSqlQuery& query)
+{
+    QVector<MachinePtr> machines;
+    
+    // Порядковые номера колонок определяются один раз на весь результат
+    const MachineColumns columns(query.record());
+    
+    while (query.next())
+        machines.append(machineFromRow(query, columns));
     
     return machines;
 }
 
+MachinePtr FleetDatabase::machineFromRow(const QSqlQuery& query, const MachineColumns& columns)
+{
+    auto machine = std::make_shared<Machine>();
+    machine->setId(query.value(columns.id).toInt());
+    machine->setName(query.value(columns.name).toString());
+    machine->setType(query.value(columns.type).toString());
+    machine->setSerialNumber(query.value(columns.serialNumber).toString());
+    machine->setYearOfManufacture(query.value(columns.yearOfManufacture).toInt());
+    machine->setStatus(Machine::statusFromCode(query.value(columns.status).toInt()));
+    
+    // Загружаем стоимость с валютой
+    const double amount = query.value(columns.cost).toDouble();
+    const Currency currency = Money::currencyFromString(query.value(columns.currency).toString());
+    machine->setCost(Money(amount, currency));
+    
+    machine->setProjectId(query.value(columns.projectId).toInt());
+    machine->setCurrentProject(query.value(columns.projectName).toString());
+    
+    // Даты - номера юлианского дня, разбор строк не нужен; NULL пропускаем
+    const QVariant assignedDate = query.value(columns.assignedDate);
+    if (!assignedDate.isNull())
+        machine->setAssignedDate(QDate::fromJulianDay(assignedDate.toLongLong()));
+    
+    machine->setMileage(query.value(columns.mileage).toInt());
+    
+    const QVariant nextMaintenanceDate = query.value(columns.nextMaintenanceDate);
+    if (!nextMaintenanceDate.isNull())
+        machine->setNextMaintenanceDate(QDate::fromJulianDay(nextMaintenanceDate.toLongLong()));
+    
+    const QVariant purchaseDate = query.value(columns.purchaseDate);
+    if (!purchaseDate.isNull())
+        machine->setPurchaseDate(QDate::fromJulianDay(purchaseDate.toLongLong()));
+    
+    machine->setWarrantyPeriod(query.value(columns.warrantyPeriod).toInt());
+    
+    return machine;
+}
+
 // ===== ОПЕРАЦИИ С ПРОЕКТАМИ =====
 
 bool FleetDatabase::addProject(ProjectPtr project)
 {
-    QSqlQuery query;
+    QSqlQuery query(database());
     query.prepare(R"(
         INSERT INTO projects (name, description)
         VALUES (?, ?)
@@ -561,12 +945,17 @@ bool FleetDatabase::addProject(ProjectPtr project)
     }
     
     project->setId(query.lastInsertId().toInt());
+    
+    emit projectChanged({ChangeEvent::Entity::Project, ChangeEvent::Operation::Inserted,
+                         project->getId(), ChangeEvent::AllFields});
     return true;
 }
 
 bool FleetDatabase::updateProject(ProjectPtr project)
 {
-    QSqlQuery query;
+    const ProjectPtr before = getProjectById(project->getId());
+    
+    QSqlQuery query(database());
     query.prepare(R"(
         UPDATE projects 
         SET name = ?, description = ?
@@ -582,12 +971,22 @@ bool FleetDatabase::updateProject(ProjectPtr project)
         return false;
     }
     
+    ChangeEvent::Fields fields = ChangeEvent::AllFields;
+    if (before) {
+        fields = ChangeEvent::NoFields;
+        if (before->getName() != project->getName()) fields |= ChangeEvent::ProjectName;
+        if (before->getDescription() != project->getDescription()) fields |= ChangeEvent::ProjectDescription;
+    }
+    if (!fields) return true; // Данные не изменились
+    
+    emit projectChanged({ChangeEvent::Entity::Project, ChangeEvent::Operation::Updated,
+                         project->getId(), fields});
     return true;
 }
 
 bool FleetDatabase::deleteProject(int projectId)
 {
-    QSqlQuery query;
+    QSqlQuery query(database());
     query.prepare("DELETE FROM projects WHERE id = ?");
     query.addBindValue(projectId);
     
@@ -596,13 +995,22 @@ bool FleetDatabase::deleteProject(int projectId)
         return false;
     }
     
+    if (query.numRowsAffected() > 0) {
+        {
+            // Проект без техники (RESTRICT) - в счётчиках остаётся только пустая запись
+            const QMutexLocker locker(&m_countersMutex);
+            m_counters.byProject.remove(projectId);
+        }
+        emit projectChanged({ChangeEvent::Entity::Project, ChangeEvent::Operation::Deleted,
+                             projectId, ChangeEvent::AllFields});
+    }
     return true;
 }
 
 QVector<ProjectPtr> FleetDatabase::getAllProjects()
 {
     QVector<ProjectPtr> projects;
-    QSqlQuery query("SELECT * FROM projects ORDER BY id");
+    QSqlQuery query("SELECT * FROM projects ORDER BY id", database());
     
     while (query.next()) {
         auto project = std::make_shared<Project>();
@@ -617,7 +1025,7 @@ QVector<ProjectPtr> FleetDatabase::getAllProjects()
 
 ProjectPtr FleetDatabase::getProjectById(int projectId)
 {
-    QSqlQuery query;
+    QSqlQuery query(database());
     query.prepare("SELECT * FROM projects WHERE id = ?");
     query.addBindValue(projectId);
     
@@ -636,64 +1044,217 @@ ProjectPtr FleetDatabase::getProjectById(int projectId)
 
 FleetDatabase::Statistics FleetDatabase::getStatistics()
 {
-    Statistics stats{0, 0, 0, 0, 0};
+    const QMutexLocker locker(&m_countersMutex);
+    return m_counters.fleet;
+}
+
+FleetDatabase::Statistics FleetDatabase::getStatisticsByProject(int projectId)
+{
+    const QMutexLocker locker(&m_countersMutex);
+    return m_counters.byProject.value(projectId, Statistics{0, 0, 0, 0, 0});
+}
+
+FleetDatabase::Statistics FleetDatabase::getStatisticsByType(const QString& type)
+{
+    const QMutexLocker locker(&m_countersMutex);
+    return m_counters.byType.value(type, Statistics{0, 0, 0, 0, 0});
+}
+
+bool FleetDatabase::countMachines(FleetCounters& counters)
+{
+    QSqlQuery query(database());
+    query.setForwardOnly(true);
+    if (!query.exec("SELECT status, project_id, type, COUNT(*) FROM machines GROUP BY status, project_id, type")) {
+        qWarning() << "Ошибка подсчёта техники:" << query.lastError().text();
+        return false;
+    }
+    
+    while (query.next()) {
+        const MachineStatus status = Machine::statusFromCode(query.value(0).toInt());
+        const int projectId = query.value(1).toInt();
+        const int count = query.value(3).toInt();
+        
+        countStatus(counters.fleet, status, count);
+        if (projectId > 0)
+            countStatus(counters.byProject[projectId], status, count);
+        countStatus(counters.byType[query.value(2).toString()], status, count);
+    }
+    
+    return true;
+}
+
+void FleetDatabase::seedCounters()
+{
+    FleetCounters counters;
+    if (!countMachines(counters)) return;
+    
+    const QMutexLocker locker(&m_countersMutex);
+    m_counters = std::move(counters);
+}
+
+void FleetDatabase::adjustCounters(const Machine& machine, int delta)
+{
+    const QMutexLocker locker(&m_countersMutex);
+    
+    countStatus(m_counters.fleet, machine.getStatus(), delta);
+    
+    if (machine.getProjectId() > 0) {
+        Statistics& project = m_counters.byProject[machine.getProjectId()];
+        countStatus(project, machine.getStatus(), delta);
+        if (project.total == 0) m_counters.byProject.remove(machine.getProjectId());
+    }
+    
+    Statistics& type = m_counters.byType[machine.getType()];
+    countStatus(type, machine.getStatus(), delta);
+    if (type.total == 0) m_counters.byType.remove(machine.getType());
+}
+
+void FleetDatabase::verifyCounters()
+{
+#ifndef QT_NO_DEBUG
+    FleetCounters actual;
+    if (!countMachines(actual)) return;
+    
+    const auto same = [](const Statistics& a, const Statistics& b) {
+        return a.total == b.total && a.available == b.available && a.onSite == b.onSite
+            && a.inRepair == b.inRepair && a.decommissioned == b.decommissioned;
+    };
+    
+    const QMutexLocker locker(&m_countersMutex);
+    
+    bool consistent = same(m_counters.fleet, actual.fleet)
+        && m_counters.byProject.size() == actual.byProject.size()
+        && m_counters.byType.size() == actual.byType.size();
+    for (auto it = actual.byProject.cbegin(); consistent && it != actual.byProject.cend(); ++it)
+        consistent = same(m_counters.byProject.value(it.key(), Statistics{0, 0, 0, 0, 0}), it.value());
+    for (auto it = actual.byType.cbegin(); consistent && it != actual.byType.cend(); ++it)
+        consistent = same(m_counters.byType.value(it.key(), Statistics{0, 0, 0, 0, 0}), it.value());
+    
+    if (!consistent) {
+        qWarning() << "Счётчики техники расходятся с базой - пересчитываются";
+        m_counters = std::move(actual);
+    }
+#endif
+}
+
+QHash<int, FleetDatabase::ProjectStatistics> FleetDatabase::getProjectStatistics()
+{
+    QHash<int, ProjectStatistics> result;
+    
+    // Строка на (проект, статус, валюта); проект без техники даёт одну строку с COUNT = 0.
+    // Суммы в разных валютах переводятся в рубли уже после группировки
+    QSqlQuery query(database());
+    query.setForwardOnly(true);
+    if (!query.exec(R"(
+        SELECT p.id, m.status, m.currency, COUNT(m.id), TOTAL(m.cost)
+        FROM projects p
+        LEFT JOIN machines m ON m.project_id = p.id
+        GROUP BY p.id, m.status, m.currency
+    )")) {
+        qWarning() << "Ошибка получения статистики проектов:" << query.lastError().text();
+        return result;
+    }
     
-    QSqlQuery query("SELECT status, COUNT(*) as count FROM machines GROUP BY status");
     while (query.next()) {
-        QString status = query.value("status").toString();
-        const int count = query.value("count").toInt();
+        ProjectStatistics& stats = result[query.value(0).toInt()];
+        
+        const int count = query.value(3).toInt();
+        if (count == 0) continue;
+        
+        countStatus(stats.machines, Machine::statusFromCode(query.value(1).toInt()), count);
         
-        if (status == "Свободна") stats.available = count;
-        else if (status == "На объекте") stats.onSite = count;
-        else if (status == "В ремонте") stats.inRepair = count;
-        else if (status == "Списана") stats.decommissioned = count;
+        const Currency currency = Money::currencyFromString(query.value(2).toString());
+        stats.totalValueRub += Money(query.value(4).toDouble(), currency).toRubles();
     }
     
-    stats.total = stats.available + stats.onSite + stats.inRepair + stats.decommissioned;
-    return stats;
+    return result;
+}
+
+void FleetDatabase::countStatus(Statistics& stats, MachineStatus status, int count)
+{
+    switch (status) {
+        case MachineStatus::Available: stats.available += count; break;
+        case MachineStatus::OnSite: stats.onSite += count; break;
+        case MachineStatus::InRepair: stats.inRepair += count; break;
+        case MachineStatus::Decommissioned: stats.decommissioned += count; break;
+    }
+    stats.total += count;
 }
 
 // ===== УПРАВЛЕНИЕ КУРСАМИ ВАЛЮТ =====
 
 bool FleetDatabase::setCurrencyRate(const QString& fromCurrency, const QString& toCurrency, double rate)
 {
-    QSqlQuery query;
-    query.prepare(R"(
-        INSERT OR REPLACE INTO currency_rates (from_currency, to_currency, rate)
-        VALUES (?, ?, ?)
-    )");
+    QSqlQuery* query = preparedQuery(kSetCurrencyRateSql);
+    if (!query) return false;
     
-    query.addBindValue(fromCurrency);
-    query.addBindValue(toCurrency);
-    query.addBindValue(rate);
+    query->bindValue(0, fromCurrency);
+    query->bindValue(1, toCurrency);
+    query->bindValue(2, rate);
     
-    if (!query.exec()) {
-        qWarning() << "Ошибка сохранения курса валют:" << query.lastError().text();
+    if (!query->exec()) {
+        qWarning() << "Ошибка сохранения курса валют:" << query->lastError().text();
         return false;
     }
     
+    storeExchangeRate(fromCurrency, toCurrency, rate);
+    emit currencyRateChanged({ChangeEvent::Entity::CurrencyRate, ChangeEvent::Operation::Updated,
+                              -1, ChangeEvent::Rate});
+    
     qDebug() << "Курс валют сохранен:" << fromCurrency << "→" << toCurrency << "=" << rate;
     return true;
 }
 
 double FleetDatabase::getCurrencyRate(const QString& fromCurrency, const QString& toCurrency)
 {
-    QSqlQuery query;
-    query.prepare("SELECT rate FROM currency_rates WHERE from_currency = ? AND to_currency = ?");
-    query.addBindValue(fromCurrency);
-    query.addBindValue(toCurrency);
+    QSqlQuery* query = preparedQuery(kSelectCurrencyRateSql);
+    if (!query) return 1.0;
     
-    if (query.exec() && query.next())
-        return query.value("rate").toDouble();
+    query->bindValue(0, fromCurrency);
+    query->bindValue(1, toCurrency);
+    
+    double rate = 1.0; // По умолчанию
+    if (query->exec() && query->next())
+        rate = query->value(0).toDouble();
+    
+    query->finish();
+    return rate;
+}
 
-    return 1.0; // По умолчанию
+double FleetDatabase::exchangeRate(const Currency from, const Currency to) const
+{
+    if (from == to) return 1.0;
+    const int index = static_cast<int>(from) * CurrencyCount + static_cast<int>(to);
+    return m_exchangeRates[index].load(std::memory_order_acquire);
 }
 
+void FleetDatabase::loadCurrencyRates()
+{
+    const auto rates = getAllCurrencyRates();
+    for (auto it = rates.cbegin(); it != rates.cend(); ++it) {
+        const QStringList pair = it.key().split('_');
+        if (pair.size() == 2)
+            storeExchangeRate(pair[0], pair[1], it.value());
+    }
+}
+
+void FleetDatabase::storeExchangeRate(const QString& fromCurrency, const QString& toCurrency, const double rate)
+{
+    const Currency from = Money::currencyFromString(fromCurrency);
+    const Currency to = Money::currencyFromString(toCurrency);
+    
+    // currencyFromString() возвращает RUB для неизвестных кодов - такие курсы не храним
+    if (Money::getCurrencyName(from) != fromCurrency || Money::getCurrencyName(to) != toCurrency)
+        return;
+    
+    const int index = static_cast<int>(from) * CurrencyCount + static_cast<int>(to);
+    m_exchangeRates[index].store(rate, std::memory_order_release);
+}
 
 QMap<QString, double> FleetDatabase::getAllCurrencyRates()
 {
     QMap<QString, double> rates;
-    QSqlQuery query("SELECT from_currency, to_currency, rate FROM currency_rates");
+    QSqlQuery query("SELECT from_currency, to_currency, rate FROM currency_rates", database());
     
     while (query.next()) {
         QString from = query.value("from_currency").toString();
@@ -706,3 +1267,91 @@ QMap<QString, double> FleetDatabase::getAllCurrencyRates()
     
     return rates;
 }
+
+// ===== КЭШ ПОДГОТОВЛЕННЫХ ЗАПРОСОВ =====
+
+QSqlQuery* FleetDatabase::preparedQuery(const QString& sql)
+{
+    ConnectionPool::Connection* connection = m_pool.acquire();
+    if (!connection) return nullptr;
+    
+    const auto it = connection->statements.find(sql);
+    if (it != connection->statements.end()) {
+        ++m_statementHits;
+        // Сбрасываем курсор предыдущего выполнения, значения будут перепривязаны
+        it->second->finish();
+        return it->second.get();
+    }
+    
+    ++m_statementMisses;
+    
+    auto query = std::make_unique<QSqlQuery>(connection->database);
+    query->setForwardOnly(true);
+    if (!query->prepare(sql)) {
+        qWarning() << "Ошибка подготовки запроса:" << query->lastError().text();
+        return nullptr;
+    }
+    
+    QSqlQuery* statement = query.get();
+    connection->statements.emplace(sql, std::move(query));
+    return statement;
+}
+
+FleetDatabase::StatementCacheStats FleetDatabase::statementCacheStats() const
+{
+    return {m_statementHits.load(), m_statementMisses.load()};
+}
+
+// ===== АСИНХРОННЫЕ ОПЕРАЦИИ (ФОНОВЫЙ ПОТОК) =====
+
+QFuture<QVector<MachinePtr>> FleetDatabase::getMachinesPageAsync(int afterId, int limit,
+                                                                const SqlCondition& condition)
+{
+    return m_worker.submit([this, afterId, limit, condition] { return getMachinesPage(afterId, limit, condition); });
+}
+
+QFuture<QVector<MachinePtr>> FleetDatabase::searchMachinesAsync(const QString& text, int limit)
+{
+    return m_worker.submit([this, text, limit] { return searchMachines(text, limit); });
+}
+
+QFuture<QHash<int, FleetDatabase::ProjectStatistics>> FleetDatabase::getProjectStatisticsAsync()
+{
+    return m_worker.submit([this] { return getProjectStatistics(); });
+}
+
+// Объекты из GUI-потока в фоновый поток передаются копиями
+
+QFuture<int> FleetDatabase::addMachineAsync(const MachinePtr& machine)
+{
+    const auto snapshot = std::make_shared<Machine>(*machine);
+    return m_worker.submit([this, snapshot] { return addMachine(snapshot) ? snapshot->getId() : -1; });
+}
+
+QFuture<bool> FleetDatabase::updateMachineAsync(const MachinePtr& machine)
+{
+    const auto snapshot = std::make_shared<Machine>(*machine);
+    return m_worker.submit([this, snapshot] { return updateMachine(snapshot); });
+}
+
+QFuture<bool> FleetDatabase::deleteMachineAsync(int machineId)
+{
+    return m_worker.submit([this, machineId] { return deleteMachine(machineId); });
+}
+
+QFuture<int> FleetDatabase::addProjectAsync(const ProjectPtr& project)
+{
+    const auto snapshot = std::make_shared<Project>(*project);
+    return m_worker.submit([this, snapshot] { return addProject(snapshot) ? snapshot->getId() : -1; });
+}
+
+QFuture<bool> FleetDatabase::updateProjectAsync(const ProjectPtr& project)
+{
+    const auto snapshot = std::make_shared<Project>(*project);
+    return m_worker.submit([this, snapshot] { return updateProject(snapshot); });
+}
+
+QFuture<bool> FleetDatabase::deleteProjectAsync(int projectId)
+{
+    return m_worker.submit([this, projectId] { return deleteProject(projectId); });
+}
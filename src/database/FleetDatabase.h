@@ -2,18 +2,121 @@
 
 #include "../models/Machine.h"
 #include "../models/Project.h"
+#include "ConnectionPool.h"
+#include "SqlCondition.h"
+#include "StorageProfile.h"
+#include "DatabaseWorker.h"
+#include <QFuture>
+#include <QObject>
+#include <QFlags>
+#include <QHash>
+#include <QSet>
 #include <QSqlDatabase>
 #include <QString>
 #include <QVector>
+#include <array>
+#include <atomic>
 #include <memory>
 
+class QSqlQuery;
+class QSqlRecord;
+
+/**
+ * @brief Описание изменения данных, о котором FleetDatabase сообщает подписчикам
+ */
+struct ChangeEvent {
+    /**
+     * @brief Изменённая сущность
+     */
+    enum class Entity {
+        Machine,        // Техника
+        Project,        // Проект
+        CurrencyRate    // Курс валют
+    };
+    
+    /**
+     * @brief Вид изменения
+     */
+    enum class Operation {
+        Inserted,       // Запись добавлена
+        Updated,        // Запись изменена
+        Deleted         // Запись удалена
+    };
+    
+    /**
+     * @brief Изменённые поля записи
+     */
+    enum Field : quint32 {
+        NoFields            = 0,
+        
+        // Техника
+        Name                = 1u << 0,
+        Type                = 1u << 1,
+        SerialNumber        = 1u << 2,
+        YearOfManufacture   = 1u << 3,
+        Status              = 1u << 4,
+        Cost                = 1u << 5,
+        CurrentProject      = 1u << 6,
+        AssignedDate        = 1u << 7,
+        Mileage             = 1u << 8,
+        NextMaintenanceDate = 1u << 9,
+        PurchaseDate        = 1u << 10,
+        WarrantyPeriod      = 1u << 11,
+        
+        // Проект
+        ProjectName         = 1u << 16,
+        ProjectDescription  = 1u << 17,
+        
+        // Курс валют
+        Rate                = 1u << 24,
+        
+        AllFields           = 0xFFFFFFFFu
+    };
+    Q_DECLARE_FLAGS(Fields, Field)
+    
+    Entity entity;
+    Operation operation;
+    int id;             // ID записи (для курсов валют - -1)
+    Fields fields;      // Изменённые поля (AllFields для добавления и удаления)
+};
+
+Q_DECLARE_OPERATORS_FOR_FLAGS(ChangeEvent::Fields)
+Q_DECLARE_METATYPE(ChangeEvent)
+
+/**
+ * @brief Операция над техникой в пакете (см. FleetDatabase::applyBatch)
+ */
+struct MachineOperation {
+    /**
+     * @brief Вид операции
+     */
+    enum class Kind {
+        Insert,         // Добавить machine, ID присваивается объекту
+        Update,         // Обновить запись machine->getId()
+        Delete          // Удалить запись machineId
+    };
+    
+    Kind kind;
+    MachinePtr machine;     // Для Insert и Update
+    int machineId = 0;      // Для Delete
+};
+
 /**
  * @brief Класс для работы с базой данных парка техники
  * 
  * Отвечает за создание таблиц, добавление, удаление, обновление
- * и получение данных о технике и проектах.
+ * и получение данных о технике и проектах. После каждого успешного
+ * изменения испускает сигнал с описанием изменения (ChangeEvent).
+ *
+ * Методы потокобезопасны: каждый поток работает через своё соединение
+ * из пула (ConnectionPool). Согласованность обеспечивает сама SQLite: в
+ * режиме WAL чтения не блокируют запись, писатели ждут друг друга через
+ * busy_timeout. Асинхронные методы (*Async) выполняются в фоновом потоке
+ * и не блокируют цикл событий.
  */
-class FleetDatabase {
+class FleetDatabase : public QObject {
+    Q_OBJECT
+
 public:
     /**
      * @brief Получить singleton-экземпляр базы данных
@@ -25,9 +128,28 @@ public:
      * @brief Инициализация базы данных
      * @param dbPath Путь к файлу базы данных
      * @param createSample Если true, будут созданы демонстрационные данные
+     * @param profile Профиль хранения (PRAGMA для каждого соединения)
      * @return true если инициализация успешна, иначе false
      */
-    bool initialize(const QString& dbPath = "fleet.db", bool createSample = false);
+    bool initialize(const QString& dbPath = "fleet.db", bool createSample = false,
+                    const StorageProfile& profile = StorageProfile::defaultProfile());
+    
+    /**
+     * @brief Текущий профиль хранения
+     */
+    StorageProfile storageProfile();
+    
+    /**
+     * @brief Сменить профиль хранения на работающей базе
+     *
+     * Соединения главного и фонового потоков закрываются и открываются
+     * заново с PRAGMA нового профиля (иначе SQLite не сменит режим
+     * журнала). Если профиль применить не удалось, например режим журнала
+     * не установлен, восстанавливается прежний профиль.
+     * @param profile Новый профиль
+     * @return true если профиль применён к соединениям обоих потоков
+     */
+    bool setStorageProfile(const StorageProfile& profile);
     
     /**
      * @brief Закрыть соединение с базой данных
@@ -57,12 +179,53 @@ public:
      */
     bool deleteMachine(int machineId);
     
+    /**
+     * @brief Добавить список техники одной транзакцией
+     * @param machines Техника для добавления (ID присваиваются объектам)
+     * @return true если добавлена вся техника, иначе false (ничего не добавлено)
+     */
+    bool addMachines(const QVector<MachinePtr>& machines);
+    
+    /**
+     * @brief Обновить список техники одной транзакцией
+     * @param machines Техника для обновления
+     * @return true если обновлена вся техника, иначе false (ничего не изменено)
+     */
+    bool updateMachines(const QVector<MachinePtr>& machines);
+    
+    /**
+     * @brief Выполнить пакет операций над техникой одной транзакцией
+     *
+     * Подготовленные запросы переиспользуются для всех строк пакета.
+     * При ошибке любой операции транзакция откатывается целиком, а ID,
+     * присвоенные добавленным объектам, возвращаются к прежним значениям.
+     * Для небольших пакетов испускается machineChanged на каждую строку,
+     * для крупных - один machinesReset. Одиночные addMachine, updateMachine
+     * и deleteMachine выполняются как пакет из одной операции.
+     * @param operations Операции в порядке выполнения
+     * @return true если выполнены все операции, иначе false
+     */
+    bool applyBatch(const QVector<MachineOperation>& operations);
+    
     /**
      * @brief Получить всю технику из базы
      * @return Вектор указателей на объекты Machine
      */
     QVector<MachinePtr> getAllMachines();
     
+    /**
+     * @brief Получить страницу техники, упорядоченной по ID
+     *
+     * Keyset-пагинация: вместо OFFSET используется условие id > afterId,
+     * поэтому стоимость страницы не зависит от её номера.
+     * @param afterId ID последней машины предыдущей страницы (0 - с начала)
+     * @param limit Максимальный размер страницы
+     * @param condition Дополнительное условие отбора (пустое - без ограничений)
+     * @return Вектор указателей на объекты Machine
+     */
+    QVector<MachinePtr> getMachinesPage(int afterId, int limit,
+                                        const SqlCondition& condition = {});
+    
     /**
      * @brief Получить технику по ID
      * @param machineId ID техники
@@ -79,10 +242,58 @@ public:
     
     /**
      * @brief Получить технику, назначенную на проект
-     * @param projectName Название проекта
+     * @param projectId ID проекта
      * @return Вектор указателей на объекты Machine
      */
-    QVector<MachinePtr> getMachinesByProject(const QString& projectName);
+    QVector<MachinePtr> getMachinesByProject(int projectId);
+    
+    /**
+     * @brief Количество техники, назначенной на проект
+     * @param projectId ID проекта
+     * @return Количество единиц техники
+     */
+    int countMachinesOnProject(int projectId);
+    
+    /**
+     * @brief Проверить, занят ли серийный номер (поиск по UNIQUE-индексу)
+     * @param serialNumber Серийный номер
+     * @param excludeMachineId ID техники, которую не учитывать (редактируемая запись)
+     * @return true если номер есть у другой техники
+     */
+    bool serialNumberExists(const QString& serialNumber, int excludeMachineId = -1);
+    
+    /**
+     * @brief Найти уже занятые серийные номера среди кандидатов (для импорта)
+     *
+     * Номера проверяются пачками через IN (...), каждый - поиском по индексу.
+     * Повторы внутри самого списка не проверяются.
+     * @param serialNumbers Проверяемые номера
+     * @return Номера из списка, которые уже есть в базе
+     */
+    QSet<QString> existingSerialNumbers(const QStringList& serialNumbers);
+    
+    /**
+     * @brief Получить технику, обслуживание которой приходится на диапазон дат
+     *
+     * Например, «в ближайшие 14 дней»: from = сегодня, until = сегодня + 14.
+     * @param from Начало диапазона (включительно); пустая дата - включая просроченное
+     * @param until Конец диапазона (включительно)
+     * @return Вектор указателей на объекты Machine, по возрастанию даты обслуживания
+     */
+    QVector<MachinePtr> getMachinesDueForMaintenance(const QDate& from, const QDate& until);
+    
+    /**
+     * @brief Полнотекстовый поиск техники по началу слов
+     *
+     * Ищет по названию, типу, серийному номеру и названию проекта через
+     * индекс machines_fts. Каждое слово запроса - префикс, все слова
+     * должны встретиться: «экск 20» найдёт «Экскаватор JCB JS220 2019».
+     * Если SQLite собрана без FTS5, таблица просматривается целиком.
+     * @param text Строка поиска
+     * @param limit Максимальное число результатов
+     * @return Вектор указателей на объекты Machine, по возрастанию ID
+     */
+    QVector<MachinePtr> searchMachines(const QString& text, int limit);
     
     // ===== ОПЕРАЦИИ С ПРОЕКТАМИ =====
     
@@ -123,8 +334,7 @@ public:
     // ===== СТАТИСТИКА =====
     
     /**
-     * @brief Получить количество техники по статусам
-     * @return Структура с количеством техники в каждом статусе
+     * @brief Количество техники по статусам
      */
     struct Statistics {
         int total;          // Всего техники
@@ -134,8 +344,43 @@ public:
         int decommissioned; // Списана
     };
     
+    /**
+     * @brief Получить количество техники по статусам
+     *
+     * Счётчики ведутся в памяти: заполняются одним запросом при
+     * инициализации и обновляются после каждого успешного изменения
+     * техники, поэтому вызов не обращается к базе. В отладочной сборке
+     * после каждого изменения счётчики сверяются с SQL.
+     * @return Структура с количеством техники в каждом статусе
+     */
     Statistics getStatistics();
     
+    /**
+     * @brief Количество техники проекта по статусам (из счётчиков в памяти)
+     * @param projectId ID проекта
+     */
+    Statistics getStatisticsByProject(int projectId);
+    
+    /**
+     * @brief Количество техники одного типа по статусам (из счётчиков в памяти)
+     * @param type Тип техники
+     */
+    Statistics getStatisticsByType(const QString& type);
+    
+    /**
+     * @brief Сводка по технике одного проекта
+     */
+    struct ProjectStatistics {
+        Statistics machines{0, 0, 0, 0, 0};  // Количество техники по статусам
+        double totalValueRub = 0.0;          // Суммарная стоимость техники в рублях
+    };
+    
+    /**
+     * @brief Получить сводку по всем проектам одним сгруппированным запросом
+     * @return Сводка по ID проекта (для проектов без техники - нули)
+     */
+    QHash<int, ProjectStatistics> getProjectStatistics();
+    
     // ===== УПРАВЛЕНИЕ КУРСАМИ ВАЛЮТ =====
     
     /**
@@ -155,11 +400,137 @@ public:
      */
     double getCurrencyRate(const QString& fromCurrency, const QString& toCurrency);
     
+    /**
+     * @brief Получить курс обмена из таблицы курсов в памяти
+     *
+     * Таблица загружается один раз в initialize() и обновляется
+     * в setCurrencyRate(). Чтение без блокировок и без запросов к БД.
+     * @param from Исходная валюта
+     * @param to Целевая валюта
+     * @return Курс обмена (1.0, если курс не задан)
+     */
+    double exchangeRate(Currency from, Currency to) const;
+    
     /**
      * @brief Получить все курсы валют
      * @return Map с ключами вида "USD_RUB" и значениями курса
      */
     QMap<QString, double> getAllCurrencyRates();
+    
+    // ===== КЭШ ПОДГОТОВЛЕННЫХ ЗАПРОСОВ =====
+    
+    /**
+     * @brief Счётчики обращений к кэшу подготовленных запросов
+     */
+    struct StatementCacheStats {
+        int hits = 0;       // Запрос взят из кэша
+        int misses = 0;     // Запрос подготовлен заново
+    };
+    
+    /**
+     * @brief Получить счётчики кэша подготовленных запросов
+     * @return Количество попаданий и промахов
+     */
+    StatementCacheStats statementCacheStats() const;
+    
+    // ===== АСИНХРОННЫЕ ОПЕРАЦИИ (ФОНОВЫЙ ПОТОК) =====
+    
+    /**
+     * @brief Асинхронно получить страницу техники (см. getMachinesPage)
+     * @param afterId ID последней машины предыдущей страницы
+     * @param limit Максимальный размер страницы (-1 - без ограничения)
+     * @param condition Дополнительное условие отбора
+     * @return QFuture с вектором указателей на объекты Machine
+     */
+    QFuture<QVector<MachinePtr>> getMachinesPageAsync(int afterId, int limit,
+                                                      const SqlCondition& condition = {});
+    
+    /**
+     * @brief Асинхронно выполнить полнотекстовый поиск (см. searchMachines)
+     * @return QFuture с вектором указателей на объекты Machine
+     */
+    QFuture<QVector<MachinePtr>> searchMachinesAsync(const QString& text, int limit);
+    
+    /**
+     * @brief Асинхронно получить сводку по проектам (см. getProjectStatistics)
+     * @return QFuture со сводкой по ID проекта
+     */
+    QFuture<QHash<int, ProjectStatistics>> getProjectStatisticsAsync();
+    
+    // Изменения выполняются в фоновом потоке, чтобы ожидание блокировки
+    // записи (busy_timeout) и fsync не останавливали интерфейс. Модели
+    // получают результат через сигналы изменений (ChangeEvent), которые
+    // доставляются в GUI-поток очередью
+    
+    /**
+     * @brief Асинхронно добавить технику
+     *
+     * В фоновый поток передаётся копия машины, поэтому ID переданному
+     * объекту не присваивается - он возвращается в результате.
+     * @param machine Указатель на объект Machine
+     * @return QFuture с ID новой записи или -1 при ошибке
+     */
+    QFuture<int> addMachineAsync(const MachinePtr& machine);
+    
+    /**
+     * @brief Асинхронно обновить технику (сохраняется копия объекта)
+     * @param machine Указатель на объект Machine
+     * @return QFuture с true при успехе
+     */
+    QFuture<bool> updateMachineAsync(const MachinePtr& machine);
+    
+    /**
+     * @brief Асинхронно удалить технику
+     * @param machineId ID техники
+     * @return QFuture с true при успехе
+     */
+    QFuture<bool> deleteMachineAsync(int machineId);
+    
+    /**
+     * @brief Асинхронно добавить проект (ID возвращается в результате, см. addMachineAsync)
+     * @param project Указатель на объект Project
+     * @return QFuture с ID новой записи или -1 при ошибке
+     */
+    QFuture<int> addProjectAsync(const ProjectPtr& project);
+    
+    /**
+     * @brief Асинхронно обновить проект (сохраняется копия объекта)
+     * @param project Указатель на объект Project
+     * @return QFuture с true при успехе
+     */
+    QFuture<bool> updateProjectAsync(const ProjectPtr& project);
+    
+    /**
+     * @brief Асинхронно удалить проект
+     * @param projectId ID проекта
+     * @return QFuture с true при успехе
+     */
+    QFuture<bool> deleteProjectAsync(int projectId);
+
+signals:
+    /**
+     * @brief Техника добавлена, изменена или удалена
+     * @param event Описание изменения
+     */
+    void machineChanged(const ChangeEvent& event);
+    
+    /**
+     * @brief Проект добавлен, изменён или удалён
+     * @param event Описание изменения
+     */
+    void projectChanged(const ChangeEvent& event);
+    
+    /**
+     * @brief Изменён курс валют
+     * @param event Описание изменения
+     */
+    void currencyRateChanged(const ChangeEvent& event);
+    
+    /**
+     * @brief Состав техники изменился слишком сильно для построчных
+     *        уведомлений (крупный пакет) - данные нужно перечитать
+     */
+    void machinesReset();
 
 private:
     FleetDatabase(); // Приватный конструктор для singleton
@@ -169,10 +540,21 @@ private:
     FleetDatabase& operator=(const FleetDatabase&) = delete;
     
     /**
-     * @brief Создать таблицы в базе данных
-     * @return true если создание успешно, иначе false
+     * @brief Применить миграции схемы (см. SchemaMigrations)
+     * @return true если схема актуальна, иначе false
      */
-    bool createTables();
+    bool migrateSchema();
+    
+    /**
+     * @brief Закрыть соединения всех потоков и открыть их с PRAGMA профиля
+     * @return true если соединения обоих потоков открыты и настроены
+     */
+    bool reopenConnections(const StorageProfile& profile);
+    
+    /**
+     * @brief Поиск без полнотекстового индекса (см. searchMachines)
+     */
+    QVector<MachinePtr> scanMachines(const QString& text, int limit);
     
     /**
      * @brief Создать тестовые данные (для демонстрации)
@@ -184,6 +566,147 @@ private:
      */
     void initializeDefaultCurrencyRates();
     
-    QSqlDatabase m_database;
-    bool m_initialized;
+    /**
+     * @brief Загрузить все курсы из currency_rates в таблицу курсов в памяти
+     */
+    void loadCurrencyRates();
+    
+    /**
+     * @brief Записать курс в таблицу курсов в памяти
+     * @param fromCurrency Исходная валюта (строка)
+     * @param toCurrency Целевая валюта (строка)
+     * @param rate Курс обмена
+     */
+    void storeExchangeRate(const QString& fromCurrency, const QString& toCurrency, double rate);
+
+    /**
+     * @brief Порядковые номера колонок таблицы machines в результате запроса
+     *
+     * Определяются один раз на результат, чтобы не искать колонку
+     * по имени для каждого поля каждой строки.
+     */
+    struct MachineColumns {
+        explicit MachineColumns(const QSqlRecord& record);
+
+        int id;
+        int name;
+        int type;
+        int serialNumber;
+        int yearOfManufacture;
+        int status;
+        int cost;
+        int currency;
+        int projectId;
+        int projectName;
+        int assignedDate;
+        int mileage;
+        int nextMaintenanceDate;
+        int purchaseDate;
+        int warrantyPeriod;
+    };
+
+    /**
+     * @brief Прочитать все строки результата в объекты Machine
+     * @param query Выполненный запрос по таблице machines
+     * @return Вектор указателей на объекты Machine
+     */
+    static QVector<MachinePtr> readMachines(QSqlQuery& query);
+
+    /**
+     * @brief Построить объект Machine из текущей строки запроса
+     * @param query Запрос, спозиционированный на строке
+     * @param columns Порядковые номера колонок
+     * @return Указатель на объект Machine
+     */
+    static MachinePtr machineFromRow(const QSqlQuery& query, const MachineColumns& columns);
+
+    /**
+     * @brief Привязать поля машины к позициям 0..12 запроса INSERT/UPDATE
+     * @param query Подготовленный запрос
+     * @param machine Машина
+     */
+    static void bindMachineFields(QSqlQuery& query, const Machine& machine);
+
+    /**
+     * @brief Начать транзакцию записи (BEGIN IMMEDIATE)
+     * @param db Соединение текущего потока
+     * @return true, если транзакция начата
+     */
+    static bool beginWriteTransaction(const QSqlDatabase& db);
+
+    /**
+     * @brief Добавить к статистике count машин в статусе status
+     */
+    static void countStatus(Statistics& stats, MachineStatus status, int count);
+
+    /**
+     * @brief Счётчики техники в памяти (см. getStatistics)
+     */
+    struct FleetCounters {
+        Statistics fleet{0, 0, 0, 0, 0};
+        QHash<int, Statistics> byProject;
+        QHash<QString, Statistics> byType;
+    };
+
+    /**
+     * @brief Посчитать счётчики одним сгруппированным запросом
+     * @return true если запрос выполнен
+     */
+    bool countMachines(FleetCounters& counters);
+
+    /**
+     * @brief Заполнить счётчики из базы (при запуске и после крупных пакетов)
+     */
+    void seedCounters();
+
+    /**
+     * @brief Учесть машину в счётчиках
+     * @param machine Машина
+     * @param delta +1 - добавлена (или новая версия), -1 - удалена (или прежняя версия)
+     */
+    void adjustCounters(const Machine& machine, int delta);
+
+    /**
+     * @brief Сверить счётчики с базой (только в отладочной сборке)
+     */
+    void verifyCounters();
+
+    /**
+     * @brief Определить, какие поля отличаются у двух версий машины
+     * @param before Версия до изменения
+     * @param after Версия после изменения
+     * @return Набор изменённых полей
+     */
+    static ChangeEvent::Fields changedMachineFields(const Machine& before, const Machine& after);
+
+    /**
+     * @brief Получить подготовленный запрос из кэша или подготовить новый
+     *
+     * Запросы живут до закрытия соединения. При повторном использовании
+     * курсор сбрасывается, значения параметров нужно привязать заново.
+     * @param sql Текст запроса (ключ кэша)
+     * @return Указатель на запрос или nullptr при ошибке подготовки
+     */
+    QSqlQuery* preparedQuery(const QString& sql);
+
+    /**
+     * @brief Соединение с базой для текущего потока (из пула)
+     */
+    QSqlDatabase database();
+
+    ConnectionPool m_pool;
+    DatabaseWorker m_worker;
+    QMutex m_lifecycleMutex;                // Защищает initialize(), close() и профиль
+    StorageProfile m_storageProfile;
+    
+    QMutex m_countersMutex;                 // Защищает m_counters
+    FleetCounters m_counters;
+    
+    std::atomic<int> m_statementHits{0};
+    std::atomic<int> m_statementMisses{0};
+    
+    // Курсы валют [from * CurrencyCount + to], каждый элемент обновляется атомарно
+    std::array<std::atomic<double>, CurrencyCount * CurrencyCount> m_exchangeRates;
+    std::atomic<bool> m_initialized;
+    std::atomic<bool> m_fullTextSearch{false};  // Индекс machines_fts создан и доступен
 };
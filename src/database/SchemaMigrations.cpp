@@ -0,0 +1,354 @@
+#include "SchemaMigrations.h"
+#include <QSqlQuery>
+#include <QSqlError>
+#include <QDebug>
+
+const QVector<Migration>& SchemaMigrations::all()
+{
+    static const QVector<Migration> migrations = {
+        {
+            1, "Исходные таблицы",
+            {
+                // IF NOT EXISTS: базы, созданные до появления миграций, имеют
+                // user_version = 0 и уже содержат эти таблицы
+                R"(
+                    CREATE TABLE IF NOT EXISTS machines (
+                        id INTEGER PRIMARY KEY AUTOINCREMENT,
+                        name TEXT NOT NULL,
+                        type TEXT NOT NULL,
+                        serial_number TEXT UNIQUE NOT NULL,
+                        year_of_manufacture INTEGER NOT NULL,
+                        status TEXT NOT NULL,
+                        cost REAL NOT NULL,
+                        currency TEXT NOT NULL DEFAULT 'RUB',
+                        current_project TEXT,
+                        assigned_date TEXT,
+                        mileage INTEGER DEFAULT 0,
+                        next_maintenance_date TEXT,
+                        purchase_date TEXT,
+                        warranty_period INTEGER DEFAULT 12
+                    )
+                )",
+                R"(
+                    CREATE TABLE IF NOT EXISTS projects (
+                        id INTEGER PRIMARY KEY AUTOINCREMENT,
+                        name TEXT NOT NULL UNIQUE,
+                        description TEXT
+                    )
+                )",
+                R"(
+                    CREATE TABLE IF NOT EXISTS currency_rates (
+                        id INTEGER PRIMARY KEY AUTOINCREMENT,
+                        from_currency TEXT NOT NULL,
+                        to_currency TEXT NOT NULL,
+                        rate REAL NOT NULL,
+                        UNIQUE(from_currency, to_currency)
+                    )
+                )"
+            }
+        },
+        {
+            2, "Индексы для выборки по статусу, проекту и дате обслуживания",
+            {
+                // Индекс неявно содержит rowid (id), поэтому ORDER BY id
+                // внутри одного значения не требует сортировки
+                "CREATE INDEX IF NOT EXISTS idx_machines_status ON machines(status)",
+                "CREATE INDEX IF NOT EXISTS idx_machines_current_project ON machines(current_project)",
+                "CREATE INDEX IF NOT EXISTS idx_machines_next_maintenance ON machines(next_maintenance_date)",
+                "ANALYZE machines"
+            }
+        },
+        {
+            3, "Статус техники хранится числовым кодом (MachineStatus)",
+            {
+                // Тип столбца в SQLite не меняется через ALTER, поэтому таблица
+                // пересоздаётся; индексы удаляются вместе со старой таблицей
+                R"(
+                    CREATE TABLE machines_new (
+                        id INTEGER PRIMARY KEY AUTOINCREMENT,
+                        name TEXT NOT NULL,
+                        type TEXT NOT NULL,
+                        serial_number TEXT UNIQUE NOT NULL,
+                        year_of_manufacture INTEGER NOT NULL,
+                        status INTEGER NOT NULL DEFAULT 0,
+                        cost REAL NOT NULL,
+                        currency TEXT NOT NULL DEFAULT 'RUB',
+                        current_project TEXT,
+                        assigned_date TEXT,
+                        mileage INTEGER DEFAULT 0,
+                        next_maintenance_date TEXT,
+                        purchase_date TEXT,
+                        warranty_period INTEGER DEFAULT 12
+                    )
+                )",
+                R"(
+                    INSERT INTO machines_new (id, name, type, serial_number, year_of_manufacture, status, cost,
+                                              currency, current_project, assigned_date, mileage,
+                                              next_maintenance_date, purchase_date, warranty_period)
+                    SELECT id, name, type, serial_number, year_of_manufacture,
+                           CASE status
+                               WHEN 'Свободна' THEN 0
+                               WHEN 'На объекте' THEN 1
+                               WHEN 'В ремонте' THEN 2
+                               WHEN 'Списана' THEN 3
+                           END,
+                           cost, currency, current_project, assigned_date, mileage,
+                           next_maintenance_date, purchase_date, warranty_period
+                    FROM machines
+                )",
+                "DROP TABLE machines",
+                "ALTER TABLE machines_new RENAME TO machines",
+                "CREATE INDEX idx_machines_status ON machines(status)",
+                "CREATE INDEX idx_machines_current_project ON machines(current_project)",
+                "CREATE INDEX idx_machines_next_maintenance ON machines(next_maintenance_date)",
+                "ANALYZE machines"
+            },
+            // Неизвестный статус нельзя молча считать "Свободна" - такую базу
+            // нужно исправить вручную (без ELSE CASE даёт NULL и нарушает NOT NULL)
+            "SELECT COUNT(*) FROM machines WHERE status NOT IN ('Свободна', 'На объекте', 'В ремонте', 'Списана')"
+        },
+        {
+            4, "Проект техники хранится внешним ключом project_id",
+            {
+                // Проект со связанной техникой удалить нельзя (RESTRICT) -
+                // технику сначала возвращают с проекта
+                R"(
+                    CREATE TABLE machines_new (
+                        id INTEGER PRIMARY KEY AUTOINCREMENT,
+                        name TEXT NOT NULL,
+                        type TEXT NOT NULL,
+                        serial_number TEXT UNIQUE NOT NULL,
+                        year_of_manufacture INTEGER NOT NULL,
+                        status INTEGER NOT NULL DEFAULT 0,
+                        cost REAL NOT NULL,
+                        currency TEXT NOT NULL DEFAULT 'RUB',
+                        project_id INTEGER REFERENCES projects(id) ON DELETE RESTRICT,
+                        assigned_date TEXT,
+                        mileage INTEGER DEFAULT 0,
+                        next_maintenance_date TEXT,
+                        purchase_date TEXT,
+                        warranty_period INTEGER DEFAULT 12
+                    )
+                )",
+                // Названия без соответствующего проекта превращаются в NULL
+                R"(
+                    INSERT INTO machines_new (id, name, type, serial_number, year_of_manufacture, status, cost,
+                                              currency, project_id, assigned_date, mileage,
+                                              next_maintenance_date, purchase_date, warranty_period)
+                    SELECT id, name, type, serial_number, year_of_manufacture, status, cost, currency,
+                           (SELECT p.id FROM projects p WHERE p.name = machines.current_project),
+                           assigned_date, mileage, next_maintenance_date, purchase_date, warranty_period
+                    FROM machines
+                )",
+                "DROP TABLE machines",
+                "ALTER TABLE machines_new RENAME TO machines",
+                "CREATE INDEX idx_machines_status ON machines(status)",
+                "CREATE INDEX idx_machines_project ON machines(project_id)",
+                "CREATE INDEX idx_machines_next_maintenance ON machines(next_maintenance_date)",
+                "ANALYZE machines"
+            }
+        },
+        {
+            5, "Даты техники хранятся номером юлианского дня",
+            {
+                R"(
+                    CREATE TABLE machines_new (
+                        id INTEGER PRIMARY KEY AUTOINCREMENT,
+                        name TEXT NOT NULL,
+                        type TEXT NOT NULL,
+                        serial_number TEXT UNIQUE NOT NULL,
+                        year_of_manufacture INTEGER NOT NULL,
+                        status INTEGER NOT NULL DEFAULT 0,
+                        cost REAL NOT NULL,
+                        currency TEXT NOT NULL DEFAULT 'RUB',
+                        project_id INTEGER REFERENCES projects(id) ON DELETE RESTRICT,
+                        assigned_date INTEGER,
+                        mileage INTEGER DEFAULT 0,
+                        next_maintenance_date INTEGER,
+                        purchase_date INTEGER,
+                        warranty_period INTEGER DEFAULT 12
+                    )
+                )",
+                // julianday() отсчитывает от полудня, QDate::toJulianDay - целый
+                // номер дня: '2000-01-01' -> 2451544.5 -> 2451545. Пустые и
+                // некорректные строки дают NULL
+                R"(
+                    INSERT INTO machines_new (id, name, type, serial_number, year_of_manufacture, status, cost,
+                                              currency, project_id, assigned_date, mileage,
+                                              next_maintenance_date, purchase_date, warranty_period)
+                    SELECT id, name, type, serial_number, year_of_manufacture, status, cost, currency, project_id,
+                           CAST(julianday(assigned_date) + 0.5 AS INTEGER),
+                           mileage,
+                           CAST(julianday(next_maintenance_date) + 0.5 AS INTEGER),
+                           CAST(julianday(purchase_date) + 0.5 AS INTEGER),
+                           warranty_period
+                    FROM machines
+                )",
+                "DROP TABLE machines",
+                "ALTER TABLE machines_new RENAME TO machines",
+                "CREATE INDEX idx_machines_status ON machines(status)",
+                "CREATE INDEX idx_machines_project ON machines(project_id)",
+                "CREATE INDEX idx_machines_next_maintenance ON machines(next_maintenance_date)",
+                "ANALYZE machines"
+            }
+        },
+        {
+            6, "Полнотекстовый индекс техники (FTS5)",
+            {
+                // rowid индекса совпадает с machines.id. Префиксные индексы
+                // на 2 и 3 символа ускоряют поиск по началу слова при вводе
+                R"(
+                    CREATE VIRTUAL TABLE machines_fts USING fts5(
+                        name, type, serial_number, current_project,
+                        tokenize = 'unicode61 remove_diacritics 2',
+                        prefix = '2 3'
+                    )
+                )",
+                R"(
+                    INSERT INTO machines_fts (rowid, name, type, serial_number, current_project)
+                    SELECT m.id, m.name, m.type, m.serial_number, p.name
+                    FROM machines m
+                    LEFT JOIN projects p ON p.id = m.project_id
+                )",
+                // Индекс поддерживается триггерами; при пересоздании machines
+                // в будущих миграциях триггеры нужно создать заново
+                R"(
+                    CREATE TRIGGER machines_fts_insert AFTER INSERT ON machines BEGIN
+                        INSERT INTO machines_fts (rowid, name, type, serial_number, current_project)
+                        VALUES (new.id, new.name, new.type, new.serial_number,
+                                (SELECT name FROM projects WHERE id = new.project_id));
+                    END
+                )",
+                R"(
+                    CREATE TRIGGER machines_fts_delete AFTER DELETE ON machines BEGIN
+                        DELETE FROM machines_fts WHERE rowid = old.id;
+                    END
+                )",
+                R"(
+                    CREATE TRIGGER machines_fts_update AFTER UPDATE OF name, type, serial_number, project_id ON machines BEGIN
+                        UPDATE machines_fts
+                        SET name = new.name, type = new.type, serial_number = new.serial_number,
+                            current_project = (SELECT name FROM projects WHERE id = new.project_id)
+                        WHERE rowid = new.id;
+                    END
+                )",
+                R"(
+                    CREATE TRIGGER machines_fts_project_rename AFTER UPDATE OF name ON projects BEGIN
+                        UPDATE machines_fts SET current_project = new.name
+                        WHERE rowid IN (SELECT id FROM machines WHERE project_id = new.id);
+                    END
+                )"
+            },
+            {},
+            // Без FTS5 индекс не создаётся, поиск просматривает таблицу
+            // (см. FleetDatabase::searchMachines)
+            "SELECT sqlite_compileoption_used('ENABLE_FTS5')"
+        }
+    };
+    return migrations;
+}
+
+int SchemaMigrations::latestVersion()
+{
+    return all().back().version;
+}
+
+bool SchemaMigrations::migrate(QSqlDatabase database)
+{
+    const int version = currentVersion(database);
+    if (version < 0) return false;
+
+    if (version > latestVersion()) {
+        qWarning() << "Схема базы данных (версия" << version
+                   << ") новее, чем поддерживает программа (версия" << latestVersion() << ")";
+        return false;
+    }
+
+    for (const Migration& migration : all()) {
+        if (migration.version <= version) continue;
+        if (!apply(database, migration)) return false;
+    }
+
+    return true;
+}
+
+int SchemaMigrations::currentVersion(const QSqlDatabase& database)
+{
+    QSqlQuery query("PRAGMA user_version", database);
+    if (!query.next()) {
+        qWarning() << "Не удалось прочитать версию схемы:" << query.lastError().text();
+        return -1;
+    }
+    return query.value(0).toInt();
+}
+
+bool SchemaMigrations::apply(QSqlDatabase& database, const Migration& migration)
+{
+    if (!database.transaction()) {
+        qWarning() << "Не удалось начать транзакцию миграции:" << database.lastError().text();
+        return false;
+    }
+
+    QSqlQuery query(database);
+    if (!migration.guard.isEmpty()) {
+        if (!query.exec(migration.guard) || !query.next()) {
+            qWarning() << "Ошибка проверки перед миграцией" << migration.version << ":" << query.lastError().text();
+            query.finish();
+            database.rollback();
+            return false;
+        }
+
+        const int rejected = query.value(0).toInt();
+        query.finish();
+        if (rejected > 0) {
+            qWarning() << "Миграция" << migration.version << "(" << migration.description << ") не применена:"
+                       << rejected << "строк с данными, которые нельзя перенести";
+            database.rollback();
+            return false;
+        }
+    }
+
+    bool supported = true;
+    if (!migration.requirement.isEmpty()) {
+        if (!query.exec(migration.requirement) || !query.next()) {
+            qWarning() << "Ошибка проверки перед миграцией" << migration.version << ":" << query.lastError().text();
+            query.finish();
+            database.rollback();
+            return false;
+        }
+        supported = query.value(0).toInt() != 0;
+        query.finish();
+        if (!supported)
+            qWarning() << "Миграция" << migration.version << "(" << migration.description << ") пропущена:"
+                       << "сборка SQLite её не поддерживает";
+    }
+
+    const QStringList statements = supported ? migration.statements : QStringList();
+    for (const QString& statement : statements) {
+        if (!query.exec(statement)) {
+            qWarning() << "Ошибка миграции" << migration.version << ":" << query.lastError().text();
+            query.finish();
+            database.rollback();
+            return false;
+        }
+    }
+
+    // user_version меняется в той же транзакции, что и схема
+    if (!query.exec(QString("PRAGMA user_version = %1").arg(migration.version))) {
+        qWarning() << "Не удалось записать версию схемы:" << query.lastError().text();
+        query.finish();
+        database.rollback();
+        return false;
+    }
+    query.finish();
+
+    if (!database.commit()) {
+        qWarning() << "Не удалось зафиксировать миграцию" << migration.version << ":"
+                   << database.lastError().text();
+        database.rollback();
+        return false;
+    }
+
+    qDebug() << "Применена миграция схемы" << migration.version << ":" << migration.description;
+    return true;
+}
@@ -0,0 +1,66 @@
+#pragma once
+
+#include <QSqlDatabase>
+#include <QString>
+#include <QStringList>
+#include <QVector>
+
+/**
+ * @brief Шаг миграции схемы базы данных
+ */
+struct Migration {
+    int version;            // Версия схемы после применения шага
+    QString description;    // Краткое описание для журнала
+    QStringList statements; // SQL-команды шага в порядке выполнения
+    QString guard;          // Запрос числа строк, которые шаг не может перенести (пусто - без проверки)
+    QString requirement;    // Запрос, возвращающий 0, если сборка SQLite не поддерживает шаг (пусто - всегда)
+};
+
+/**
+ * @brief Версионные миграции схемы, управляемые PRAGMA user_version
+ *
+ * Версия схемы хранится в заголовке файла базы (user_version). При запуске
+ * применяются по порядку все шаги с версией выше текущей, каждый в своей
+ * транзакции вместе с записью новой версии, поэтому прерванная миграция
+ * не оставляет схему в промежуточном состоянии.
+ *
+ * Новые изменения схемы добавляются только новыми шагами в конец списка;
+ * уже выпущенные шаги не редактируются.
+ */
+class SchemaMigrations {
+public:
+    /**
+     * @brief Все шаги миграции в порядке возрастания версии
+     */
+    static const QVector<Migration>& all();
+
+    /**
+     * @brief Последняя версия схемы, известная программе
+     */
+    static int latestVersion();
+
+    /**
+     * @brief Привести схему базы к последней версии
+     * @param database Открытое соединение
+     * @return true если схема актуальна, иначе false
+     */
+    static bool migrate(QSqlDatabase database);
+
+private:
+    /**
+     * @brief Прочитать PRAGMA user_version
+     * @return Версия схемы или -1 при ошибке
+     */
+    static int currentVersion(const QSqlDatabase& database);
+
+    /**
+     * @brief Применить один шаг в транзакции
+     *
+     * Если у шага есть guard и он находит строки, которые шаг не может
+     * перенести, шаг не применяется. Если requirement сообщает, что сборка
+     * SQLite шаг не поддерживает, команды шага пропускаются, а версия
+     * схемы всё равно повышается - шаг необязательный.
+     * @return true если шаг применён, иначе false (транзакция откатывается)
+     */
+    static bool apply(QSqlDatabase& database, const Migration& migration);
+};
@@ -0,0 +1,15 @@
+#pragma once
+
+#include <QString>
+#include <QVariantList>
+
+/**
+ * @brief Условие для WHERE запроса техники (m - machines, p - projects)
+ *
+ * Текст условия с параметрами ? и их значения по порядку. Строится вне
+ * слоя базы (например, фильтром таблицы) и подставляется в запрос как есть.
+ */
+struct SqlCondition {
+    QString where;              // Пусто - без ограничений
+    QVariantList bindings;      // Значения параметров ? по порядку
+};
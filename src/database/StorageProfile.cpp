@@ -0,0 +1,56 @@
+#include "StorageProfile.h"
+
+QStringList StorageProfile::pragmas() const
+{
+    // busy_timeout первым: смена режима журнала может ждать чужую блокировку
+    return {
+        QString("PRAGMA busy_timeout = %1").arg(busyTimeoutMs),
+        QString("PRAGMA journal_mode = %1").arg(journalMode),
+        QString("PRAGMA synchronous = %1").arg(synchronous),
+        QString("PRAGMA cache_size = %1").arg(-cacheSizeKib),
+        QString("PRAGMA mmap_size = %1").arg(mmapSize),
+        QString("PRAGMA temp_store = %1").arg(tempStore),
+        "PRAGMA foreign_keys = ON"
+    };
+}
+
+const QVector<StorageProfile>& StorageProfile::all()
+{
+    static const QVector<StorageProfile> profiles = {
+        {
+            "workstation",
+            "Рабочая станция",
+            "База на локальном диске. WAL: чтения не блокируют запись, "
+            "fsync только при контрольной точке.",
+            "WAL", "NORMAL", 16 * 1024, 256ll * 1024 * 1024, "MEMORY", 5000
+        },
+        {
+            "shared-drive",
+            "Сетевой диск",
+            "База в общей сетевой папке. WAL и mmap на сетевых файловых "
+            "системах не поддерживаются, поэтому используется журнал отката "
+            "с полной синхронизацией и долгим ожиданием блокировки.",
+            "DELETE", "FULL", 8 * 1024, 0, "DEFAULT", 30000
+        },
+        {
+            "bulk-import",
+            "Массовая загрузка",
+            "Максимальная скорость записи. Без fsync: при сбое питания "
+            "последние изменения могут быть потеряны.",
+            "WAL", "OFF", 64 * 1024, 512ll * 1024 * 1024, "MEMORY", 5000
+        }
+    };
+    return profiles;
+}
+
+const StorageProfile& StorageProfile::byId(const QString& id)
+{
+    for (const StorageProfile& profile : all())
+        if (profile.id == id) return profile;
+    return defaultProfile();
+}
+
+const StorageProfile& StorageProfile::defaultProfile()
+{
+    return all().front();
+}
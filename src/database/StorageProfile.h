@@ -0,0 +1,47 @@
+#pragma once
+
+#include <QString>
+#include <QStringList>
+#include <QVector>
+
+/**
+ * @brief Профиль хранения SQLite: набор PRAGMA под типичный сценарий работы
+ *
+ * Профиль задаёт режим журнала, уровень синхронизации, размер кэша страниц,
+ * размер отображаемой в память области, размещение временных данных и
+ * время ожидания блокировки. Одни и те же PRAGMA выполняются на соединении
+ * каждого потока.
+ */
+struct StorageProfile {
+    QString id;             // Ключ для сохранения в настройках
+    QString title;          // Название для интерфейса
+    QString description;    // Краткое пояснение компромиссов
+
+    QString journalMode;    // DELETE, WAL, ...
+    QString synchronous;    // OFF, NORMAL, FULL
+    int cacheSizeKib = 0;   // Размер кэша страниц на соединение, КиБ
+    qint64 mmapSize = 0;    // Размер mmap-области, байт (0 - отключено)
+    QString tempStore;      // DEFAULT, FILE, MEMORY
+    int busyTimeoutMs = 0;  // Ожидание блокировки другим соединением, мс
+
+    /**
+     * @brief Команды PRAGMA для нового соединения
+     */
+    QStringList pragmas() const;
+
+    /**
+     * @brief Все доступные профили
+     */
+    static const QVector<StorageProfile>& all();
+
+    /**
+     * @brief Найти профиль по ключу
+     * @return Профиль или профиль по умолчанию, если ключ неизвестен
+     */
+    static const StorageProfile& byId(const QString& id);
+
+    /**
+     * @brief Профиль по умолчанию ("workstation")
+     */
+    static const StorageProfile& defaultProfile();
+};
@@ -6,12 +6,15 @@
 #include <QStyleFactory>
 #include <QFile>
 #include <QMessageBox>
+#include <QSettings>
 
 int main(int argc, char* argv[])
 {
     QApplication::setHighDpiScaleFactorRoundingPolicy(Qt::HighDpiScaleFactorRoundingPolicy::PassThrough);
 
     QApplication app(argc, argv);
+    QApplication::setOrganizationName("FleetManager");
+    QApplication::setApplicationName("FleetManager");
 
     QFont defaultFont("Segoe UI");
 
@@ -70,8 +73,12 @@ int main(int argc, char* argv[])
         } else return 0; // Пользователь закрыл окно или нажал Отмена
     }
 
+    // Профиль хранения выбирается в окне настроек
+    const QSettings settings;
+    const StorageProfile& profile = StorageProfile::byId(settings.value("storage/profile").toString());
+
     // Инициализация базы данных
-    if (!FleetDatabase::instance().initialize(dbPath, createSample)) {
+    if (!FleetDatabase::instance().initialize(dbPath, createSample, profile)) {
         QMessageBox::critical(nullptr, "Ошибка", "Не удалось инициализировать базу данных!");
         return 1;
     }
@@ -0,0 +1,76 @@
+#include "Bitmap.h"
+#include <algorithm>
+#include <bit>
+
+namespace {
+
+constexpr qsizetype wordCount(const qsizetype bits)
+{
+    return (bits + 63) / 64;
+}
+
+} // namespace
+
+Bitmap::Bitmap(const qsizetype size, const bool value)
+    : m_words(wordCount(size), value ? ~quint64(0) : 0)
+    , m_size(size)
+{
+    // Биты за пределами size() всегда сброшены
+    if (value && (size & 63))
+        m_words.last() &= (quint64(1) << (size & 63)) - 1;
+}
+
+void Bitmap::resize(const qsizetype size)
+{
+    m_words.resize(wordCount(size));
+    m_size = size;
+}
+
+void Bitmap::set(const qsizetype bit)
+{
+    if (bit >= m_size) resize(bit + 1);
+    m_words[bit >> 6] |= quint64(1) << (bit & 63);
+}
+
+void Bitmap::reset(const qsizetype bit)
+{
+    if (bit >= m_size) return;
+    m_words[bit >> 6] &= ~(quint64(1) << (bit & 63));
+}
+
+qsizetype Bitmap::count() const
+{
+    qsizetype result = 0;
+    for (const quint64 word : m_words)
+        result += std::popcount(word);
+    return result;
+}
+
+Bitmap& Bitmap::operator&=(const Bitmap& other)
+{
+    const qsizetype common = std::min(m_words.size(), other.m_words.size());
+    for (qsizetype i = 0; i < common; ++i)
+        m_words[i] &= other.m_words[i];
+    resize(std::min(m_size, other.m_size));
+    return *this;
+}
+
+Bitmap& Bitmap::operator|=(const Bitmap& other)
+{
+    if (other.m_size > m_size) resize(other.m_size);
+    for (qsizetype i = 0; i < other.m_words.size(); ++i)
+        m_words[i] |= other.m_words[i];
+    return *this;
+}
+
+void Bitmap::appendSetBits(QVector<int>& out) const
+{
+    out.reserve(out.size() + count());
+    for (qsizetype i = 0; i < m_words.size(); ++i) {
+        quint64 word = m_words[i];
+        while (word) {
+            out.append(static_cast<int>(i * 64 + std::countr_zero(word)));
+            word &= word - 1;
+        }
+    }
+}
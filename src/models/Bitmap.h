@@ -0,0 +1,60 @@
+#pragma once
+
+#include <QVector>
+#include <QtGlobal>
+
+/**
+ * @brief Битовая карта слотов FleetStore
+ *
+ * Бит i установлен, если слот i входит в множество. Карты объединяются и
+ * пересекаются по 64 слота за операцию, а номера установленных битов
+ * выбираются без просмотра пустых слов. Биты за пределами size() считаются
+ * сброшенными, поэтому карты разной длины совместимы.
+ */
+class Bitmap {
+public:
+    Bitmap() = default;
+
+    /**
+     * @brief Карта заданной длины, все биты равны value
+     */
+    explicit Bitmap(qsizetype size, bool value = false);
+
+    qsizetype size() const { return m_size; }
+
+    bool test(const qsizetype bit) const
+    {
+        return bit < m_size && (m_words[bit >> 6] >> (bit & 63) & 1);
+    }
+
+    /**
+     * @brief Установить бит (карта удлиняется при необходимости)
+     */
+    void set(qsizetype bit);
+
+    void reset(qsizetype bit);
+
+    /**
+     * @brief Количество установленных битов
+     */
+    qsizetype count() const;
+
+    Bitmap& operator&=(const Bitmap& other);
+    Bitmap& operator|=(const Bitmap& other);
+
+    /**
+     * @brief Объём памяти карты, байт
+     */
+    qsizetype memoryUsage() const { return m_words.capacity() * static_cast<qsizetype>(sizeof(quint64)); }
+
+    /**
+     * @brief Дописать номера установленных битов по возрастанию
+     */
+    void appendSetBits(QVector<int>& out) const;
+
+private:
+    void resize(qsizetype size);
+
+    QVector<quint64> m_words;
+    qsizetype m_size = 0;
+};
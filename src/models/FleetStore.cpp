@@ -0,0 +1,235 @@
+#include "FleetStore.h"
+
+namespace {
+
+// Объём памяти массива без учёта данных, на которые ссылаются элементы
+template <typename T>
+qsizetype vectorBytes(const QVector<T>& vector)
+{
+    return vector.capacity() * static_cast<qsizetype>(sizeof(T));
+}
+
+// Объём памяти массива строк вместе с их символами
+qsizetype stringVectorBytes(const QVector<QString>& strings)
+{
+    qsizetype bytes = vectorBytes(strings);
+    for (const QString& string : strings)
+        bytes += string.capacity() * static_cast<qsizetype>(sizeof(QChar));
+    return bytes;
+}
+
+} // namespace
+
+int StringPool::intern(const QString& value)
+{
+    const auto it = m_ids.constFind(value);
+    if (it != m_ids.cend()) return it.value();
+
+    const int id = m_values.size();
+    m_values.append(value);
+    m_ids.insert(value, id);
+    return id;
+}
+
+qsizetype StringPool::memoryUsage() const
+{
+    // Ключи хэша разделяют данные со строками m_values
+    return stringVectorBytes(m_values)
+         + m_ids.capacity() * static_cast<qsizetype>(sizeof(QString) + sizeof(int));
+}
+
+void StringPool::clear()
+{
+    m_values.clear();
+    m_ids.clear();
+}
+
+int FleetStore::append(const Machine& machine)
+{
+    const int slot = slotCount();
+    const int newSize = slot + 1;
+
+    m_ids.resize(newSize);
+    m_names.resize(newSize);
+    m_typeIds.resize(newSize);
+    m_serialNumbers.resize(newSize);
+    m_years.resize(newSize);
+    m_statuses.resize(newSize);
+    m_costAmounts.resize(newSize);
+    m_currencies.resize(newSize);
+    m_projectIds.resize(newSize);
+    m_projectNameIds.resize(newSize);
+    m_assignedDays.resize(newSize);
+    m_mileages.resize(newSize);
+    m_maintenanceDays.resize(newSize);
+    m_purchaseDays.resize(newSize);
+    m_warrantyPeriods.resize(newSize);
+
+    write(slot, machine);
+    ++m_revision;
+    return slot;
+}
+
+void FleetStore::assign(const int slot, const Machine& machine)
+{
+    m_slotById.remove(m_ids[slot]);
+    indexSlot(slot, false);
+    write(slot, machine);
+    ++m_revision;
+}
+
+void FleetStore::write(const int slot, const Machine& machine)
+{
+    m_ids[slot] = machine.getId();
+    m_names[slot] = machine.getName();
+    m_typeIds[slot] = m_strings.intern(machine.getType());
+    m_serialNumbers[slot] = machine.getSerialNumber();
+    m_years[slot] = static_cast<qint16>(machine.getYearOfManufacture());
+    m_statuses[slot] = static_cast<quint8>(Machine::statusToCode(machine.getStatus()));
+    m_costAmounts[slot] = machine.getCost().getAmount();
+    m_currencies[slot] = static_cast<quint8>(machine.getCost().getCurrency());
+    m_projectIds[slot] = machine.getProjectId();
+    m_projectNameIds[slot] = m_strings.intern(machine.getCurrentProject());
+    m_assignedDays[slot] = machine.getAssignedDate().toJulianDay();
+    m_mileages[slot] = machine.getMileage();
+    m_maintenanceDays[slot] = machine.getNextMaintenanceDate().toJulianDay();
+    m_purchaseDays[slot] = machine.getPurchaseDate().toJulianDay();
+    m_warrantyPeriods[slot] = static_cast<qint16>(machine.getWarrantyPeriod());
+
+    m_slotById.insert(machine.getId(), slot);
+    m_projectNames.insert(m_projectIds[slot], m_projectNameIds[slot]);
+    indexSlot(slot, true);
+}
+
+void FleetStore::indexSlot(const int slot, const bool present)
+{
+    Bitmap& status = m_statusSlots[m_statuses[slot]];
+    Bitmap& project = m_projectSlots[m_projectIds[slot]];
+    Bitmap& type = m_typeSlots[m_typeIds[slot]];
+
+    if (present) {
+        m_liveSlots.set(slot);
+        status.set(slot);
+        project.set(slot);
+        type.set(slot);
+    } else {
+        m_liveSlots.reset(slot);
+        status.reset(slot);
+        project.reset(slot);
+        type.reset(slot);
+    }
+}
+
+void FleetStore::remove(const int slot)
+{
+    // Слот остаётся пустым - сдвиг столбцов и карт стоил бы O(n) на каждое удаление
+    m_slotById.remove(m_ids[slot]);
+    indexSlot(slot, false);
+
+    m_names[slot] = QString();
+    m_serialNumbers[slot] = QString();
+    ++m_revision;
+}
+
+void FleetStore::clear()
+{
+    m_ids.clear();
+    m_names.clear();
+    m_typeIds.clear();
+    m_serialNumbers.clear();
+    m_years.clear();
+    m_statuses.clear();
+    m_costAmounts.clear();
+    m_currencies.clear();
+    m_projectIds.clear();
+    m_projectNameIds.clear();
+    m_assignedDays.clear();
+    m_mileages.clear();
+    m_maintenanceDays.clear();
+    m_purchaseDays.clear();
+    m_warrantyPeriods.clear();
+
+    m_strings.clear();
+    m_slotById.clear();
+    m_projectNames.clear();
+
+    m_liveSlots = Bitmap();
+    for (Bitmap& bitmap : m_statusSlots) bitmap = Bitmap();
+    m_projectSlots.clear();
+    m_typeSlots.clear();
+    ++m_revision;
+}
+
+MachinePtr FleetStore::machine(const int slot) const
+{
+    auto machine = std::make_shared<Machine>(name(slot), type(slot), serialNumber(slot),
+                                             yearOfManufacture(slot), cost(slot));
+    machine->setId(id(slot));
+    machine->setStatus(status(slot));
+    machine->setProjectId(projectId(slot));
+    machine->setCurrentProject(projectName(slot));
+    machine->setAssignedDate(assignedDate(slot));
+    machine->setMileage(mileage(slot));
+    machine->setNextMaintenanceDate(nextMaintenanceDate(slot));
+    machine->setPurchaseDate(purchaseDate(slot));
+    machine->setWarrantyPeriod(warrantyPeriod(slot));
+    return machine;
+}
+
+bool FleetStore::renameProject(const int projectId, const QString& name)
+{
+    const int nameId = m_strings.intern(name);
+    m_projectNames.insert(projectId, nameId);
+
+    bool renamed = false;
+    for (int slot = 0; slot < m_projectIds.size(); ++slot) {
+        if (m_projectIds[slot] != projectId || !m_liveSlots.test(slot)) continue;
+        m_projectNameIds[slot] = nameId;
+        renamed = true;
+    }
+    if (renamed) ++m_revision;
+    return renamed;
+}
+
+Bitmap FleetStore::projectSlots(const QString& name) const
+{
+    Bitmap slots;
+    const int nameId = m_strings.find(name);
+    if (nameId < 0) return slots;
+
+    // Проектов немного - просматриваем все, одно название может быть у нескольких
+    for (auto it = m_projectNames.cbegin(); it != m_projectNames.cend(); ++it)
+        if (it.value() == nameId) slots |= m_projectSlots.value(it.key());
+    return slots;
+}
+
+qsizetype FleetStore::memoryUsage() const
+{
+    return vectorBytes(m_ids)
+         + stringVectorBytes(m_names)
+         + vectorBytes(m_typeIds)
+         + stringVectorBytes(m_serialNumbers)
+         + vectorBytes(m_years)
+         + vectorBytes(m_statuses)
+         + vectorBytes(m_costAmounts)
+         + vectorBytes(m_currencies)
+         + vectorBytes(m_projectIds)
+         + vectorBytes(m_projectNameIds)
+         + vectorBytes(m_assignedDays)
+         + vectorBytes(m_mileages)
+         + vectorBytes(m_maintenanceDays)
+         + vectorBytes(m_purchaseDays)
+         + vectorBytes(m_warrantyPeriods)
+         + m_strings.memoryUsage()
+         + (m_slotById.capacity() + m_projectNames.capacity()) * static_cast<qsizetype>(2 * sizeof(int))
+         + bitmapBytes();
+}
+
+qsizetype FleetStore::bitmapBytes() const
+{
+    qsizetype bytes = m_liveSlots.memoryUsage();
+    for (const Bitmap& bitmap : m_statusSlots) bytes += bitmap.memoryUsage();
+    for (const Bitmap& bitmap : m_projectSlots) bytes += bitmap.memoryUsage();
+    for (const Bitmap& bitmap : m_typeSlots) bytes += bitmap.memoryUsage();
+    return bytes;
+}
@@ -0,0 +1,211 @@
+#pragma once
+
+#include <QDate>
+#include <QHash>
+#include <QString>
+#include <QVector>
+#include <array>
+#include "Bitmap.h"
+#include "Machine.h"
+
+/**
+ * @brief Пул интернированных строк
+ *
+ * Повторяющиеся значения (тип техники, название проекта) хранятся один раз,
+ * в столбцах лежат только их номера.
+ */
+class StringPool {
+public:
+    /**
+     * @brief Номер строки в пуле, строка добавляется при первом обращении
+     */
+    int intern(const QString& value);
+
+    /**
+     * @brief Номер строки без добавления в пул
+     * @return Номер или -1, если строки в пуле нет
+     */
+    int find(const QString& value) const { return m_ids.value(value, -1); }
+
+    /**
+     * @brief Строка по номеру
+     */
+    const QString& value(const int id) const { return m_values[id]; }
+
+    /**
+     * @brief Количество различных строк
+     */
+    int size() const { return m_values.size(); }
+
+    /**
+     * @brief Приблизительный объём памяти пула, байт
+     */
+    qsizetype memoryUsage() const;
+
+    void clear();
+
+private:
+    QVector<QString> m_values;          // Строки по номеру
+    QHash<QString, int> m_ids;          // Строка -> номер
+};
+
+/**
+ * @brief Хранилище загруженного парка по столбцам (struct-of-arrays)
+ *
+ * Каждое поле машины лежит в своём непрерывном массиве, индекс в массиве -
+ * слот машины. Фильтрация, сортировка и подсчёты читают только нужные
+ * столбцы подряд, без обхода отдельных объектов Machine в куче. Тип техники
+ * и название проекта интернированы в StringPool, даты хранятся номером
+ * юлианского дня (как в базе).
+ *
+ * Для статуса, проекта и типа техники поддерживаются битовые карты слотов,
+ * обновляемые вместе со столбцами: выборка по этим полям - пересечение и
+ * объединение карт без просмотра строк.
+ *
+ * Удалённая машина оставляет в хранилище пустой слот: остальные слоты не
+ * сдвигаются, поэтому индексы и кэши над ними остаются верными. Новые машины
+ * всегда занимают слоты в конце, так что порядок слотов - порядок добавления.
+ * Пустые слоты освобождаются при clear().
+ */
+class FleetStore {
+public:
+    /**
+     * @brief Количество машин в хранилище
+     */
+    int size() const { return m_slotById.size(); }
+    bool isEmpty() const { return m_slotById.isEmpty(); }
+
+    /**
+     * @brief Количество слотов вместе с пустыми - граница номеров слотов
+     */
+    int slotCount() const { return m_ids.size(); }
+
+    /**
+     * @brief Добавить машину в конец
+     * @return Слот новой машины
+     */
+    int append(const Machine& machine);
+
+    /**
+     * @brief Перезаписать поля машины в слоте
+     */
+    void assign(int slot, const Machine& machine);
+
+    /**
+     * @brief Удалить машину, слот остаётся пустым (другие слоты не меняются)
+     */
+    void remove(int slot);
+
+    void clear();
+
+    /**
+     * @brief Слот машины по ID
+     * @return Слот или -1, если машина не загружена
+     */
+    int slotOf(int machineId) const { return m_slotById.value(machineId, -1); }
+
+    /**
+     * @brief Собрать объект Machine из столбцов слота
+     */
+    MachinePtr machine(int slot) const;
+
+    /**
+     * @brief Подставить новое название проекта во все его машины
+     * @return true если у проекта есть загруженные машины
+     */
+    bool renameProject(int projectId, const QString& name);
+
+    // Чтение столбцов по слоту
+    int id(const int slot) const { return m_ids[slot]; }
+    const QString& name(const int slot) const { return m_names[slot]; }
+    const QString& type(const int slot) const { return m_strings.value(m_typeIds[slot]); }
+    const QString& serialNumber(const int slot) const { return m_serialNumbers[slot]; }
+    int yearOfManufacture(const int slot) const { return m_years[slot]; }
+    MachineStatus status(const int slot) const { return static_cast<MachineStatus>(m_statuses[slot]); }
+    Money cost(const int slot) const { return Money(m_costAmounts[slot], static_cast<Currency>(m_currencies[slot])); }
+    int projectId(const int slot) const { return m_projectIds[slot]; }
+    const QString& projectName(const int slot) const { return m_strings.value(m_projectNameIds[slot]); }
+    QDate assignedDate(const int slot) const { return QDate::fromJulianDay(m_assignedDays[slot]); }
+    int mileage(const int slot) const { return m_mileages[slot]; }
+    QDate nextMaintenanceDate(const int slot) const { return QDate::fromJulianDay(m_maintenanceDays[slot]); }
+    QDate purchaseDate(const int slot) const { return QDate::fromJulianDay(m_purchaseDays[slot]); }
+    int warrantyPeriod(const int slot) const { return m_warrantyPeriods[slot]; }
+
+    /**
+     * @brief Слоты машин с заданным статусом
+     */
+    const Bitmap& statusSlots(const MachineStatus status) const { return m_statusSlots[Machine::statusToCode(status)]; }
+
+    /**
+     * @brief Слоты машин на проектах с заданным названием
+     */
+    Bitmap projectSlots(const QString& name) const;
+
+    /**
+     * @brief Слоты машин заданного типа
+     */
+    Bitmap typeSlots(const QString& type) const { return m_typeSlots.value(m_strings.find(type)); }
+
+    /**
+     * @brief Все занятые слоты хранилища
+     */
+    const Bitmap& allSlots() const { return m_liveSlots; }
+
+    // Столбцы целиком - для последовательного просмотра
+    const QVector<quint8>& statuses() const { return m_statuses; }
+    const QVector<int>& projectIds() const { return m_projectIds; }
+
+    /**
+     * @brief Номер версии данных, увеличивается при каждом изменении хранилища
+     */
+    quint64 revision() const { return m_revision; }
+
+    /**
+     * @brief Приблизительный объём памяти хранилища, байт
+     */
+    qsizetype memoryUsage() const;
+
+private:
+    /**
+     * @brief Записать поля машины в слот (столбцы уже нужного размера)
+     */
+    void write(int slot, const Machine& machine);
+
+    /**
+     * @brief Отметить слот в битовых картах по текущим значениям столбцов
+     * @param present true - установить биты, false - сбросить
+     */
+    void indexSlot(int slot, bool present);
+
+    /**
+     * @brief Объём памяти битовых карт, байт
+     */
+    qsizetype bitmapBytes() const;
+
+    QVector<int> m_ids;
+    QVector<QString> m_names;
+    QVector<int> m_typeIds;             // Номер в m_strings
+    QVector<QString> m_serialNumbers;
+    QVector<qint16> m_years;
+    QVector<quint8> m_statuses;         // MachineStatus
+    QVector<double> m_costAmounts;
+    QVector<quint8> m_currencies;       // Currency
+    QVector<int> m_projectIds;          // 0 - не назначена
+    QVector<int> m_projectNameIds;      // Номер в m_strings
+    QVector<qint64> m_assignedDays;     // Юлианский день (toJulianDay() пустой даты - нет даты)
+    QVector<int> m_mileages;
+    QVector<qint64> m_maintenanceDays;
+    QVector<qint64> m_purchaseDays;
+    QVector<qint16> m_warrantyPeriods;
+
+    quint64 m_revision = 0;             // Версия данных для кэшей над хранилищем
+    StringPool m_strings;               // Типы техники и названия проектов
+    QHash<int, int> m_slotById;         // ID машины -> слот
+    QHash<int, int> m_projectNames;     // ID проекта -> номер названия в m_strings
+
+    // Битовые карты слотов
+    Bitmap m_liveSlots;                                     // Занятые слоты
+    std::array<Bitmap, MachineStatusCount> m_statusSlots;   // Индекс - MachineStatus
+    QHash<int, Bitmap> m_projectSlots;                      // ID проекта -> слоты
+    QHash<int, Bitmap> m_typeSlots;                         // Номер типа в m_strings -> слоты
+};
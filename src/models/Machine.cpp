@@ -5,6 +5,7 @@ Machine::Machine()
     , m_yearOfManufacture(2020)
     , m_status(MachineStatus::Available)
     , m_cost(0.0, Currency::RUB)
+    , m_projectId(0)
     , m_mileage(0)
     , m_nextMaintenanceDate(QDate(2026, 5, 1))
     , m_purchaseDate(QDate(2022, 1, 1))
@@ -24,6 +25,7 @@ Machine::Machine(const QString& name,
     , m_yearOfManufacture(yearOfManufacture)
     , m_status(MachineStatus::Available)
     , m_cost(cost)
+    , m_projectId(0)
     , m_mileage(0)
     , m_nextMaintenanceDate(QDate(2026, 5, 1))
     , m_purchaseDate(QDate(2022, 1, 1))
@@ -33,26 +35,15 @@ Machine::Machine(const QString& name,
 
 QString Machine::statusToString(MachineStatus status)
 {
-    switch (status) {
-        case MachineStatus::Available:
-            return "Свободна";
-        case MachineStatus::OnSite:
-            return "На объекте";
-        case MachineStatus::InRepair:
-            return "В ремонте";
-        case MachineStatus::Decommissioned:
-            return "Списана";
-        default:
-            return "Неизвестно";
-    }
+    const int code = statusToCode(status);
+    if (code < 0 || code >= MachineStatusCount) return "Неизвестно";
+    return MachineStatusNames[code].toString();
 }
 
 MachineStatus Machine::stringToStatus(const QString& str)
 {
-    if (str == "Свободна") return MachineStatus::Available;
-    if (str == "На объекте") return MachineStatus::OnSite;
-    if (str == "В ремонте") return MachineStatus::InRepair;
-    if (str == "Списана") return MachineStatus::Decommissioned;
+    for (int code = 0; code < MachineStatusCount; ++code)
+        if (QStringView(str) == MachineStatusNames[code]) return static_cast<MachineStatus>(code);
     
     return MachineStatus::Available; // По умолчанию
 }
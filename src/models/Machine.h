@@ -1,12 +1,16 @@
 #pragma once
 
 #include <QString>
+#include <QStringView>
 #include <QDate>
+#include <array>
 #include <memory>
 #include "Money.h"
 
 /**
  * @brief Статус техники в парке
+ *
+ * Числовые значения хранятся в столбце machines.status - не менять.
  */
 enum class MachineStatus {
     Available,      // Свободна
@@ -15,6 +19,21 @@ enum class MachineStatus {
     Decommissioned  // Списана
 };
 
+/**
+ * @brief Количество статусов техники
+ */
+inline constexpr int MachineStatusCount = static_cast<int>(MachineStatus::Decommissioned) + 1;
+
+/**
+ * @brief Отображаемые названия статусов, индекс - значение MachineStatus
+ */
+inline constexpr std::array<QStringView, MachineStatusCount> MachineStatusNames = {
+    u"Свободна",
+    u"На объекте",
+    u"В ремонте",
+    u"Списана"
+};
+
 /**
  * @brief Класс, представляющий единицу техники в парке
  * 
@@ -50,6 +69,7 @@ public:
     int getYearOfManufacture() const { return m_yearOfManufacture; }
     MachineStatus getStatus() const { return m_status; }
     Money getCost() const { return m_cost; }
+    int getProjectId() const { return m_projectId; }
     QString getCurrentProject() const { return m_currentProject; }
     QDate getAssignedDate() const { return m_assignedDate; }
     int getMileage() const { return m_mileage; }
@@ -65,6 +85,7 @@ public:
     void setYearOfManufacture(int year) { m_yearOfManufacture = year; }
     void setStatus(MachineStatus status) { m_status = status; }
     void setCost(const Money& cost) { m_cost = cost; }
+    void setProjectId(int projectId) { m_projectId = projectId; }
     void setCurrentProject(const QString& project) { m_currentProject = project; }
     void setAssignedDate(const QDate& date) { m_assignedDate = date; }
     void setMileage(int mileage) { m_mileage = mileage; }
@@ -85,6 +106,22 @@ public:
      * @return Статус техники
      */
     static MachineStatus stringToStatus(const QString& str);
+    
+    /**
+     * @brief Преобразует числовой код из базы данных в статус
+     * @param code Значение столбца status
+     * @return Статус техники (Available для неизвестного кода)
+     */
+    static constexpr MachineStatus statusFromCode(int code)
+    {
+        return code >= 0 && code < MachineStatusCount ? static_cast<MachineStatus>(code)
+                                                      : MachineStatus::Available;
+    }
+    
+    /**
+     * @brief Числовой код статуса для хранения в базе данных
+     */
+    static constexpr int statusToCode(MachineStatus status) { return static_cast<int>(status); }
 
 private:
     int m_id;                           // ID в базе данных
@@ -94,7 +131,8 @@ private:
     int m_yearOfManufacture;            // Год выпуска
     MachineStatus m_status;             // Текущий статус
     Money m_cost;                       // Стоимость
-    QString m_currentProject;            // Текущий проект (если назначена)
+    int m_projectId;                    // ID текущего проекта (0 - не назначена)
+    QString m_currentProject;            // Название текущего проекта (из projects по m_projectId)
     QDate m_assignedDate;               // Дата назначения на проект
     int m_mileage;                      // Пробег
     QDate m_nextMaintenanceDate;        // Дата следующего обслуживания
@@ -0,0 +1,369 @@
+#include "MachineFilter.h"
+#include <QDate>
+#include <QStringList>
+#include <algorithm>
+
+namespace {
+
+// Лексема выражения фильтра
+struct Token {
+    enum class Kind { Word, Operator };
+    Kind kind;
+    QString text;
+    bool quoted = false;
+};
+
+bool isOperatorChar(const QChar ch)
+{
+    return ch == '=' || ch == '!' || ch == '<' || ch == '>' || ch == '~';
+}
+
+bool tokenize(const QString& text, QVector<Token>& tokens, QString& error)
+{
+    qsizetype i = 0;
+    while (i < text.size()) {
+        const QChar ch = text[i];
+        if (ch.isSpace()) {
+            ++i;
+            continue;
+        }
+
+        if (ch == '"') {
+            const qsizetype end = text.indexOf('"', i + 1);
+            if (end < 0) {
+                error = "Не закрыта кавычка";
+                return false;
+            }
+            tokens.append({Token::Kind::Word, text.mid(i + 1, end - i - 1), true});
+            i = end + 1;
+            continue;
+        }
+
+        const qsizetype start = i;
+        if (isOperatorChar(ch)) {
+            while (i < text.size() && isOperatorChar(text[i])) ++i;
+            tokens.append({Token::Kind::Operator, text.mid(start, i - start)});
+            continue;
+        }
+
+        while (i < text.size() && !text[i].isSpace() && !isOperatorChar(text[i]) && text[i] != '"') ++i;
+        tokens.append({Token::Kind::Word, text.mid(start, i - start)});
+    }
+    return true;
+}
+
+bool isAnd(const Token& token)
+{
+    if (token.kind != Token::Kind::Word || token.quoted) return false;
+    const QString word = token.text.toLower();
+    return word == "и" || word == "and" || word == "&&";
+}
+
+bool isOr(const Token& token)
+{
+    if (token.kind != Token::Kind::Word || token.quoted) return false;
+    const QString word = token.text.toLower();
+    return word == "или" || word == "or" || word == "||";
+}
+
+} // namespace
+
+MachineFilter MachineFilter::parse(const QString& text, QString* error)
+{
+    MachineFilter filter;
+    QString message;
+
+    const auto fail = [&](const QString& reason) {
+        if (error) *error = reason;
+        return MachineFilter();
+    };
+
+    QVector<Token> tokens;
+    if (!tokenize(text, tokens, message)) return fail(message);
+
+    Group group;
+    qsizetype i = 0;
+    while (i < tokens.size()) {
+        // поле оператор значение [значение ...]
+        if (tokens[i].kind != Token::Kind::Word || isAnd(tokens[i]) || isOr(tokens[i]))
+            return fail(QString("Ожидается название поля вместо \"%1\"").arg(tokens[i].text));
+        const QString field = tokens[i++].text;
+
+        if (i >= tokens.size() || tokens[i].kind != Token::Kind::Operator)
+            return fail(QString("После поля \"%1\" ожидается оператор").arg(field));
+        const QString op = tokens[i++].text;
+
+        // Значение без кавычек может состоять из нескольких слов - до "и"/"или"
+        QStringList words;
+        while (i < tokens.size() && tokens[i].kind == Token::Kind::Word && !isAnd(tokens[i]) && !isOr(tokens[i]))
+            words.append(tokens[i++].text);
+        if (words.isEmpty())
+            return fail(QString("Не указано значение для поля \"%1\"").arg(field));
+
+        Condition condition;
+        if (!parseCondition(field, op, words.join(' '), condition, message)) return fail(message);
+        group.append(condition);
+
+        if (i >= tokens.size()) break;
+        if (isOr(tokens[i])) {
+            filter.m_groups.append(group);
+            group.clear();
+        } else if (!isAnd(tokens[i])) {
+            return fail(QString("Ожидается \"и\" или \"или\" вместо \"%1\"").arg(tokens[i].text));
+        }
+        if (++i >= tokens.size()) return fail("Выражение обрывается после \"и\"/\"или\"");
+    }
+    if (!group.isEmpty()) filter.m_groups.append(group);
+
+    // План проверки: сначала битовые карты, затем числовые столбцы, текст - последним
+    const auto rank = [](const Condition& condition) {
+        if (isBitmapServed(condition)) return 0;
+        switch (condition.field) {
+        case Field::Name: case Field::Type: case Field::SerialNumber: case Field::Project: return 2;
+        default: return 1;
+        }
+    };
+    for (Group& conditions : filter.m_groups)
+        std::ranges::stable_sort(conditions, {}, rank);
+
+    filter.m_text = text.trimmed();
+    if (error) error->clear();
+    return filter;
+}
+
+bool MachineFilter::parseCondition(const QString& field, const QString& op, const QString& value,
+                                   Condition& condition, QString& error)
+{
+    static const QHash<QString, Field> fields = {
+        {"название", Field::Name}, {"name", Field::Name},
+        {"тип", Field::Type}, {"type", Field::Type},
+        {"серийный", Field::SerialNumber}, {"serial", Field::SerialNumber},
+        {"статус", Field::Status}, {"status", Field::Status},
+        {"проект", Field::Project}, {"project", Field::Project},
+        {"год", Field::Year}, {"year", Field::Year},
+        {"пробег", Field::Mileage}, {"mileage", Field::Mileage},
+        {"стоимость", Field::Cost}, {"cost", Field::Cost},
+        {"гарантия", Field::Warranty}, {"warranty", Field::Warranty},
+        {"обслуживание", Field::MaintenanceDays}, {"maintenance", Field::MaintenanceDays}
+    };
+    static const QHash<QString, Operator> operators = {
+        {"=", Operator::Equal}, {"==", Operator::Equal},
+        {"!=", Operator::NotEqual}, {"<>", Operator::NotEqual},
+        {"<", Operator::Less}, {"<=", Operator::LessEqual},
+        {">", Operator::Greater}, {">=", Operator::GreaterEqual},
+        {"~", Operator::Contains}
+    };
+
+    const auto fieldIt = fields.constFind(field.toLower());
+    if (fieldIt == fields.cend()) {
+        error = QString("Неизвестное поле \"%1\"").arg(field);
+        return false;
+    }
+    const auto opIt = operators.constFind(op);
+    if (opIt == operators.cend()) {
+        error = QString("Неизвестный оператор \"%1\"").arg(op);
+        return false;
+    }
+
+    condition.field = fieldIt.value();
+    condition.op = opIt.value();
+    condition.text = value;
+
+    switch (condition.field) {
+    case Field::Name: case Field::Type: case Field::SerialNumber: case Field::Project:
+        if (condition.op != Operator::Equal && condition.op != Operator::NotEqual && condition.op != Operator::Contains) {
+            error = QString("Для поля \"%1\" допустимы только =, != и ~").arg(field);
+            return false;
+        }
+        return true;
+
+    case Field::Status: {
+        if (condition.op != Operator::Equal && condition.op != Operator::NotEqual) {
+            error = "Для статуса допустимы только = и !=";
+            return false;
+        }
+        const auto it = std::ranges::find_if(MachineStatusNames, [&](const QStringView name) {
+            return name.compare(value, Qt::CaseInsensitive) == 0;
+        });
+        if (it == MachineStatusNames.end()) {
+            error = QString("Неизвестный статус \"%1\"").arg(value);
+            return false;
+        }
+        condition.status = static_cast<int>(it - MachineStatusNames.begin());
+        return true;
+    }
+
+    default: {
+        if (condition.op == Operator::Contains) {
+            error = QString("Оператор ~ не применим к полю \"%1\"").arg(field);
+            return false;
+        }
+        bool ok = false;
+        condition.number = QString(value).replace(',', '.').toDouble(&ok);
+        if (!ok) {
+            error = QString("Значение \"%1\" для поля \"%2\" должно быть числом").arg(value, field);
+            return false;
+        }
+        return true;
+    }
+    }
+}
+
+bool MachineFilter::isIndexed(const Condition& condition)
+{
+    switch (condition.field) {
+    case Field::Status: return true;                                    // idx_machines_status
+    case Field::Project: return condition.op == Operator::Equal;        // idx_machines_project
+    case Field::MaintenanceDays: return condition.op != Operator::NotEqual; // idx_machines_next_maintenance
+    default: return false;
+    }
+}
+
+bool MachineFilter::isBitmapServed(const Condition& condition)
+{
+    return condition.op == Operator::Equal
+        && (condition.field == Field::Status || condition.field == Field::Type || condition.field == Field::Project);
+}
+
+template <typename T>
+bool MachineFilter::compare(const T left, const Operator op, const T right)
+{
+    switch (op) {
+    case Operator::Less: return left < right;
+    case Operator::LessEqual: return left <= right;
+    case Operator::Greater: return left > right;
+    case Operator::GreaterEqual: return left >= right;
+    case Operator::NotEqual: return left != right;
+    default: return left == right;
+    }
+}
+
+QString MachineFilter::sqlOperator(const Operator op)
+{
+    switch (op) {
+    case Operator::Less: return "<";
+    case Operator::LessEqual: return "<=";
+    case Operator::Greater: return ">";
+    case Operator::GreaterEqual: return ">=";
+    case Operator::NotEqual: return "<>";
+    default: return "=";
+    }
+}
+
+SqlCondition MachineFilter::sqlCondition() const
+{
+    const qint64 today = QDate::currentDate().toJulianDay();
+
+    SqlCondition result;
+    QStringList groups;
+    for (const Group& group : m_groups) {
+        QStringList terms;
+        for (const Condition& condition : group) {
+            if (!isIndexed(condition)) continue;
+            switch (condition.field) {
+            case Field::Status:
+                terms.append("m.status " + sqlOperator(condition.op) + " ?");
+                result.bindings.append(condition.status);
+                break;
+            case Field::Project:
+                terms.append("m.project_id IN (SELECT id FROM projects WHERE name = ?)");
+                result.bindings.append(condition.text);
+                break;
+            default:
+                terms.append("m.next_maintenance_date " + sqlOperator(condition.op) + " ?");
+                result.bindings.append(today + qRound64(condition.number));
+                break;
+            }
+        }
+
+        // Группу без индексируемых условий база не сузит - фильтр целиком в памяти
+        if (terms.isEmpty()) return {};
+        groups.append("(" + terms.join(" AND ") + ")");
+    }
+
+    result.where = groups.join(" OR ");
+    return result;
+}
+
+Bitmap MachineFilter::evaluate(const FleetStore& store) const
+{
+    if (isEmpty()) return store.allSlots();
+
+    const qint64 today = QDate::currentDate().toJulianDay();
+
+    Bitmap result(store.slotCount());
+    for (const Group& group : m_groups) {
+        // Условия отсортированы при разборе: битовые карты идут первыми
+        Bitmap slots = store.allSlots();
+        qsizetype first = 0;
+        for (; first < group.size() && isBitmapServed(group[first]); ++first)
+            slots &= bitmapFor(store, group[first]);
+
+        if (first < group.size()) {
+            QVector<int> candidates;
+            slots.appendSetBits(candidates);
+            for (const int slot : std::as_const(candidates)) {
+                for (qsizetype i = first; i < group.size(); ++i) {
+                    if (test(store, slot, group[i], today)) continue;
+                    slots.reset(slot);
+                    break;
+                }
+            }
+        }
+
+        result |= slots;
+    }
+    return result;
+}
+
+bool MachineFilter::accepts(const FleetStore& store, const int slot) const
+{
+    if (isEmpty()) return true;
+
+    const qint64 today = QDate::currentDate().toJulianDay();
+    return std::ranges::any_of(m_groups, [&](const Group& group) {
+        return std::ranges::all_of(group, [&](const Condition& condition) {
+            return test(store, slot, condition, today);
+        });
+    });
+}
+
+Bitmap MachineFilter::bitmapFor(const FleetStore& store, const Condition& condition)
+{
+    switch (condition.field) {
+    case Field::Status: return store.statusSlots(Machine::statusFromCode(condition.status));
+    case Field::Project: return store.projectSlots(condition.text);
+    default: return store.typeSlots(condition.text);
+    }
+}
+
+bool MachineFilter::test(const FleetStore& store, const int slot, const Condition& condition, const qint64 today)
+{
+    const auto testText = [&](const QString& value) {
+        switch (condition.op) {
+        case Operator::Equal: return value == condition.text;
+        case Operator::NotEqual: return value != condition.text;
+        default: return value.contains(condition.text, Qt::CaseInsensitive);
+        }
+    };
+    const Operator op = condition.op;
+
+    switch (condition.field) {
+    case Field::Name: return testText(store.name(slot));
+    case Field::Type: return testText(store.type(slot));
+    case Field::SerialNumber: return testText(store.serialNumber(slot));
+    case Field::Project: return testText(store.projectName(slot));
+    case Field::Status: return compare(Machine::statusToCode(store.status(slot)), op, condition.status);
+    case Field::Year: return compare<double>(store.yearOfManufacture(slot), op, condition.number);
+    case Field::Mileage: return compare<double>(store.mileage(slot), op, condition.number);
+    case Field::Cost: return compare(store.cost(slot).toRubles(), op, condition.number);
+    case Field::Warranty: return compare<double>(store.warrantyPeriod(slot), op, condition.number);
+    case Field::MaintenanceDays: {
+        // Машина без запланированного обслуживания условию не соответствует
+        const QDate date = store.nextMaintenanceDate(slot);
+        if (!date.isValid()) return false;
+        return compare<double>(static_cast<double>(date.toJulianDay() - today), op, qRound64(condition.number));
+    }
+    }
+    return false;
+}
@@ -0,0 +1,132 @@
+#pragma once
+
+#include <QString>
+#include <QVector>
+#include "Bitmap.h"
+#include "FleetStore.h"
+#include "../database/SqlCondition.h"
+
+/**
+ * @brief Составной фильтр техники
+ *
+ * Выражение вида
+ *     тип = Экскаватор и пробег > 5000 и обслуживание <= 30
+ * разбирается один раз в дизъюнкцию конъюнкций простых условий
+ * ("или" связывает группы, "и" - условия внутри группы).
+ *
+ * Поля: название, тип, серийный, статус, проект, год, пробег, стоимость
+ * (в рублях), гарантия (месяцев), обслуживание (дней до следующего
+ * обслуживания). Операторы: = != < <= > >= и ~ (содержит без учёта
+ * регистра, для текста); = и != для текста сравнивают точно. Значения с
+ * пробелами можно брать в кавычки.
+ *
+ * Условия, которые обслуживаются индексами базы (статус, проект, дата
+ * обслуживания), переносятся в WHERE запроса загрузки. В памяти условия
+ * "статус =", "тип =" и "проект =" выбираются битовыми картами FleetStore,
+ * а остальные проверяются по столбцам только для оставшихся слотов. Группы,
+ * связанные "или", объединяются по битовым картам.
+ */
+class MachineFilter {
+public:
+    /**
+     * @brief Пустой фильтр, пропускает всю технику
+     */
+    MachineFilter() = default;
+
+    /**
+     * @brief Разобрать выражение фильтра
+     * @param text Текст выражения (пустой - фильтр без условий)
+     * @param error Текст ошибки разбора, если выражение некорректно
+     * @return Фильтр; при ошибке - пустой фильтр и непустой error
+     */
+    static MachineFilter parse(const QString& text, QString* error = nullptr);
+
+    bool isEmpty() const { return m_groups.isEmpty(); }
+
+    /**
+     * @brief Исходный текст выражения
+     */
+    const QString& text() const { return m_text; }
+
+    /**
+     * @brief Часть фильтра, которую можно выполнить индексами базы
+     *
+     * Условие ослаблено: пропускает все подходящие машины и, возможно,
+     * часть лишних, поэтому загруженные строки всё равно проверяются
+     * фильтром целиком.
+     */
+    SqlCondition sqlCondition() const;
+
+    /**
+     * @brief Слоты хранилища, проходящие фильтр
+     */
+    Bitmap evaluate(const FleetStore& store) const;
+
+    /**
+     * @brief Проходит ли фильтр машина в одном слоте
+     */
+    bool accepts(const FleetStore& store, int slot) const;
+
+private:
+    enum class Field {
+        Name, Type, SerialNumber, Status, Project,
+        Year, Mileage, Cost, Warranty, MaintenanceDays
+    };
+
+    enum class Operator { Equal, NotEqual, Less, LessEqual, Greater, GreaterEqual, Contains };
+
+    /**
+     * @brief Простое условие "поле оператор значение"
+     */
+    struct Condition {
+        Field field;
+        Operator op;
+        QString text;               // Текстовое значение (название, тип, проект, ...)
+        double number = 0.0;        // Числовое значение (год, пробег, стоимость, дни)
+        int status = 0;             // Код статуса для поля "статус"
+    };
+
+    using Group = QVector<Condition>;   // Условия, связанные "и"
+
+    /**
+     * @brief Разобрать одно условие
+     * @return false и текст ошибки, если условие некорректно
+     */
+    static bool parseCondition(const QString& field, const QString& op, const QString& value,
+                               Condition& condition, QString& error);
+
+    /**
+     * @brief Сравнить значения оператором фильтра
+     */
+    template <typename T>
+    static bool compare(T left, Operator op, T right);
+
+    /**
+     * @brief Оператор SQL для оператора сравнения
+     */
+    static QString sqlOperator(Operator op);
+
+    /**
+     * @brief Выполнимо ли условие индексом базы
+     */
+    static bool isIndexed(const Condition& condition);
+
+    /**
+     * @brief Выполнимо ли условие битовой картой хранилища
+     */
+    static bool isBitmapServed(const Condition& condition);
+
+    /**
+     * @brief Битовая карта слотов для условия (только isBitmapServed)
+     */
+    static Bitmap bitmapFor(const FleetStore& store, const Condition& condition);
+
+    /**
+     * @brief Проверить условие для слота по столбцам хранилища
+     * @param today Сегодняшний юлианский день (для поля "обслуживание")
+     */
+    static bool test(const FleetStore& store, int slot, const Condition& condition, qint64 today);
+
+    QVector<Group> m_groups;        // Группы, связанные "или"
+    QString m_text;
+};
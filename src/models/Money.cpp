@@ -24,7 +24,8 @@ double Money::toRubles() const
 
 QString Money::toString() const
 {
-    const QLocale locale(QLocale::Russian);
+    // Локаль создаётся один раз: toString() вызывается для каждой ячейки стоимости
+    static const QLocale locale(QLocale::Russian);
     const QString symbol = getCurrencySymbol(m_currency);
     
     const QString formattedAmount = locale.toString(m_amount, 'f', 0);
@@ -62,10 +63,8 @@ double Money::getExchangeRate(Currency from, Currency to)
 {
     if (from == to) return 1.0;
 
-    // Получаем курс из базы данных
-    QString fromStr = getCurrencyName(from);
-    QString toStr = getCurrencyName(to);
-    return FleetDatabase::instance().getCurrencyRate(fromStr, toStr);
+    // Курсы загружены в память при инициализации БД, запроса к SQLite нет
+    return FleetDatabase::instance().exchangeRate(from, to);
 }
 
 bool Money::operator<(const Money& other) const
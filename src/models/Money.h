@@ -11,6 +11,11 @@ enum class Currency {
     USD  // Доллар США
 };
 
+/**
+ * @brief Количество поддерживаемых валют (размерность таблицы курсов)
+ */
+inline constexpr int CurrencyCount = static_cast<int>(Currency::USD) + 1;
+
 /**
  * @brief Класс для работы с денежными суммами в разных валютах
  * 
@@ -80,7 +85,7 @@ public:
     static Currency currencyFromString(const QString& name);
     
     /**
-     * @brief Получить курс обмена из БД
+     * @brief Получить курс обмена из таблицы курсов в памяти
      * @param from Исходная валюта
      * @param to Целевая валюта
      * @return Курс обмена
@@ -0,0 +1,4 @@
+#include "PerformanceLog.h"
+
+// Сообщения qCDebug по умолчанию отключены - замеры не засоряют журнал
+Q_LOGGING_CATEGORY(lcPerformance, "fleet.performance", QtInfoMsg)
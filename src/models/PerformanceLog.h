@@ -0,0 +1,11 @@
+#pragma once
+
+#include <QLoggingCategory>
+
+/**
+ * @brief Категория замеров производительности (время загрузки, фильтра, память)
+ *
+ * По умолчанию выключена. Включается переменной окружения
+ *     QT_LOGGING_RULES="fleet.performance.debug=true"
+ */
+Q_DECLARE_LOGGING_CATEGORY(lcPerformance)
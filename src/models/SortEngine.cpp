@@ -0,0 +1,71 @@
+#include "SortEngine.h"
+#include <array>
+
+namespace {
+
+// Строка вместе с ключом - проходы читают память подряд
+struct Entry {
+    quint64 key;
+    int row;
+};
+
+constexpr int RadixBits = 8;
+constexpr int RadixBuckets = 1 << RadixBits;
+constexpr int RadixPasses = 64 / RadixBits;
+
+int digitOf(const quint64 key, const int pass)
+{
+    return static_cast<int>((key >> (pass * RadixBits)) & (RadixBuckets - 1));
+}
+
+} // namespace
+
+void SortEngine::radixSort(QVector<int>& rows, const QVector<quint64>& keys, const bool descending)
+{
+    const qsizetype size = rows.size();
+    if (size < 2) return;
+
+    // Убывание - возрастание по инвертированному ключу, устойчивость сохраняется
+    const quint64 mask = descending ? ~quint64(0) : 0;
+
+    if (size < RadixThreshold) {
+        std::stable_sort(rows.begin(), rows.end(), [&](const int a, const int b) {
+            return (keys[a] ^ mask) < (keys[b] ^ mask);
+        });
+        return;
+    }
+
+    std::vector<Entry> entries(size);
+    std::vector<Entry> buffer(size);
+    std::vector<std::array<qsizetype, RadixBuckets>> counts(RadixPasses);
+    for (auto& count : counts) count.fill(0);
+
+    // Гистограммы всех разрядов за один проход
+    for (qsizetype i = 0; i < size; ++i) {
+        const quint64 key = keys[rows[i]] ^ mask;
+        entries[i] = {key, rows[i]};
+        for (int pass = 0; pass < RadixPasses; ++pass)
+            ++counts[pass][digitOf(key, pass)];
+    }
+
+    for (int pass = 0; pass < RadixPasses; ++pass) {
+        auto& count = counts[pass];
+
+        // Разряд одинаков у всех строк - проход ничего не меняет
+        if (count[digitOf(entries[0].key, pass)] == size) continue;
+
+        qsizetype offset = 0;
+        for (qsizetype& bucket : count) {
+            const qsizetype bucketSize = bucket;
+            bucket = offset;
+            offset += bucketSize;
+        }
+
+        for (const Entry& entry : entries)
+            buffer[count[digitOf(entry.key, pass)]++] = entry;
+        entries.swap(buffer);
+    }
+
+    for (qsizetype i = 0; i < size; ++i)
+        rows[i] = entries[i].row;
+}
@@ -0,0 +1,105 @@
+#pragma once
+
+#include <QVector>
+#include <QtGlobal>
+#include <algorithm>
+#include <bit>
+#include <thread>
+#include <vector>
+
+/**
+ * @brief Устойчивая сортировка строк таблицы по ключам
+ *
+ * Строки задаются номерами (слотами), ключи лежат в отдельном массиве,
+ * индексированном теми же номерами. Обе сортировки устойчивы: строки с
+ * равными ключами сохраняют текущий порядок, поэтому последовательная
+ * сортировка по нескольким колонкам даёт упорядочивание по нескольким
+ * ключам.
+ */
+class SortEngine {
+public:
+    /**
+     * @brief Целочисленный ключ, беззнаковое сравнение которого совпадает
+     *        со знаковым сравнением исходных значений
+     */
+    static constexpr quint64 orderedKey(const qint64 value)
+    {
+        return static_cast<quint64>(value) ^ (quint64(1) << 63);
+    }
+
+    /**
+     * @brief Целочисленный ключ, беззнаковое сравнение которого совпадает
+     *        со сравнением исходных чисел с плавающей точкой (кроме NaN)
+     */
+    static quint64 orderedKey(const double value)
+    {
+        const quint64 bits = std::bit_cast<quint64>(value);
+        // Отрицательные числа: порядок битов обратный - инвертируем всё
+        return bits & (quint64(1) << 63) ? ~bits : bits | (quint64(1) << 63);
+    }
+
+    /**
+     * @brief Поразрядная (LSD) сортировка строк по 64-битным ключам
+     *
+     * Байты ключа, одинаковые у всех строк, пропускаются, поэтому год или
+     * статус сортируются за один-два прохода подсчётом.
+     * @param rows Номера строк
+     * @param keys Ключи, индекс - номер строки
+     * @param descending true - по убыванию (равные ключи остаются в текущем порядке)
+     */
+    static void radixSort(QVector<int>& rows, const QVector<quint64>& keys, bool descending);
+
+    /**
+     * @brief Устойчивая сортировка слиянием на нескольких потоках
+     *
+     * Части массива сортируются параллельно std::stable_sort, затем
+     * попарно сливаются, слияния одного уровня тоже идут параллельно.
+     * Небольшие массивы сортируются в текущем потоке.
+     * @param rows Номера строк
+     * @param less Строгий слабый порядок; вызывается из нескольких потоков
+     */
+    template <typename Less>
+    static void parallelStableSort(QVector<int>& rows, Less less);
+
+private:
+    // Минимальный размер части для отдельного потока
+    static constexpr qsizetype ParallelChunkSize = 32 * 1024;
+
+    // Ниже этого размера подсчёт проигрывает обычной сортировке
+    static constexpr qsizetype RadixThreshold = 256;
+};
+
+template <typename Less>
+void SortEngine::parallelStableSort(QVector<int>& rows, Less less)
+{
+    const qsizetype size = rows.size();
+    const qsizetype hardwareThreads = std::max(1u, std::thread::hardware_concurrency());
+    const int parts = static_cast<int>(std::min(hardwareThreads, size / ParallelChunkSize));
+
+    int* const data = rows.data();
+    if (parts <= 1) {
+        std::stable_sort(data, data + size, less);
+        return;
+    }
+
+    std::vector<qsizetype> bounds(parts + 1);
+    for (int i = 0; i <= parts; ++i)
+        bounds[i] = size * i / parts;
+
+    {
+        std::vector<std::jthread> workers;
+        for (int i = 0; i < parts; ++i)
+            workers.emplace_back([=] { std::stable_sort(data + bounds[i], data + bounds[i + 1], less); });
+    }
+
+    // Слияние соседних частей; левая часть идёт первой при равенстве - порядок устойчив
+    for (int width = 1; width < parts; width *= 2) {
+        std::vector<std::jthread> workers;
+        for (int i = 0; i + width < parts; i += 2 * width) {
+            int* const first = data + bounds[i];
+            int* const middle = data + bounds[i + width];
+            int* const last = data + bounds[std::min(i + 2 * width, parts)];
+            workers.emplace_back([=] { std::inplace_merge(first, middle, last, less); });
+        }
+    }
+}
@@ -0,0 +1,265 @@
+#include <QCollator>
+#include <QElapsedTimer>
+#include <QSqlDatabase>
+#include <QSqlQuery>
+#include <QSqlRecord>
+#include <QTemporaryDir>
+#include <QtTest>
+#include <algorithm>
+#include <limits>
+#include <numeric>
+#include "../database/FleetDatabase.h"
+#include "../models/FleetStore.h"
+#include "../models/MachineFilter.h"
+#include "../models/SortEngine.h"
+
+/**
+ * @brief Замеры производительности на парке из FleetSize машин
+ *
+ * Запускается вручную, сборка должна быть Release:
+ *     bench_fleet [-iterations N]
+ */
+class BenchFleet : public QObject {
+    Q_OBJECT
+
+private slots:
+    void initTestCase();
+    void cleanupTestCase();
+
+    void loadAllMachines();
+    void readColumns_data();
+    void readColumns();
+
+    void storeMemoryPerMachine();
+    void scanColumn();
+
+    void radixSort_data();
+    void radixSort();
+    void parallelStableSort();
+
+    void filterEvaluate_data();
+    void filterEvaluate();
+
+private:
+    static constexpr int FleetSize = 200000;
+    static constexpr int SortSize = 1000000;    // Сортировка - на миллионе строк
+
+    /**
+     * @brief Машина с номером i, поля распределены по всем значениям фильтров
+     */
+    static MachinePtr makeMachine(int i);
+
+    QTemporaryDir m_dir;
+    FleetStore m_store;             // Тот же парк в памяти
+};
+
+MachinePtr BenchFleet::makeMachine(const int i)
+{
+    static const QStringList types = { "Экскаватор", "Бульдозер", "Автокран", "Погрузчик", "Самосвал" };
+
+    auto machine = std::make_shared<Machine>(QString("Машина %1").arg(i), types[i % types.size()],
+                                             QString("SN-%1").arg(i), 2000 + i % 25,
+                                             Money(1000000 + (i % 1000) * 5000, Currency::RUB));
+    machine->setStatus(Machine::statusFromCode(i % MachineStatusCount));
+    machine->setMileage(i * 37 % 20000);
+    machine->setNextMaintenanceDate(QDate::currentDate().addDays(i % 90));
+    machine->setPurchaseDate(QDate(2020, 1, 1).addDays(i % 1500));
+    machine->setWarrantyPeriod(12 + i % 4 * 12);
+    return machine;
+}
+
+void BenchFleet::initTestCase()
+{
+    QVERIFY(m_dir.isValid());
+    QVERIFY(FleetDatabase::instance().initialize(m_dir.filePath("fleet.db")));
+
+    QVector<MachinePtr> machines;
+    machines.reserve(FleetSize);
+    for (int i = 0; i < FleetSize; ++i) machines.append(makeMachine(i));
+    QVERIFY(FleetDatabase::instance().addMachines(machines));
+
+    for (const MachinePtr& machine : machines) m_store.append(*machine);
+}
+
+void BenchFleet::cleanupTestCase()
+{
+    FleetDatabase::instance().close();
+}
+
+void BenchFleet::loadAllMachines()
+{
+    QElapsedTimer timer;
+    timer.start();
+    QCOMPARE(FleetDatabase::instance().getAllMachines().size(), FleetSize);
+    qInfo("Загрузка: %.0f строк/с", FleetSize * 1000.0 / std::max<qint64>(timer.elapsed(), 1));
+
+    QBENCHMARK {
+        FleetDatabase::instance().getAllMachines();
+    }
+}
+
+void BenchFleet::readColumns_data()
+{
+    QTest::addColumn<bool>("byName");
+
+    // Прежний разбор строки (поиск колонки по имени для каждого поля)
+    // против номеров колонок, найденных один раз на весь результат
+    QTest::newRow("по имени") << true;
+    QTest::newRow("по номеру") << false;
+}
+
+void BenchFleet::readColumns()
+{
+    QFETCH(bool, byName);
+
+    static const QStringList fields = {
+        "id", "name", "type", "serial_number", "year_of_manufacture", "status", "cost", "currency",
+        "project_id", "assigned_date", "mileage", "next_maintenance_date", "purchase_date", "warranty_period"
+    };
+
+    // Отдельное соединение: замеряется чтение результата, а не FleetDatabase
+    {
+        QSqlDatabase database = QSqlDatabase::addDatabase("QSQLITE", "bench");
+        database.setDatabaseName(m_dir.filePath("fleet.db"));
+        QVERIFY(database.open());
+
+        QBENCHMARK {
+            QSqlQuery query(database);
+            query.setForwardOnly(true);
+            QVERIFY(query.exec("SELECT * FROM machines"));
+
+            QVector<int> columns;
+            for (const QString& field : fields) columns.append(query.record().indexOf(field));
+
+            qint64 checksum = 0;
+            while (query.next()) {
+                for (int i = 0; i < fields.size(); ++i) {
+                    const QVariant value = byName ? query.value(fields[i]) : query.value(columns[i]);
+                    checksum += value.isNull() ? 0 : 1;
+                }
+            }
+            QVERIFY(checksum > 0);
+        }
+    }
+    QSqlDatabase::removeDatabase("bench");
+}
+
+void BenchFleet::storeMemoryPerMachine()
+{
+    QCOMPARE(m_store.size(), FleetSize);
+    qInfo("FleetStore: %lld байт на машину", static_cast<long long>(m_store.memoryUsage() / m_store.size()));
+}
+
+void BenchFleet::scanColumn()
+{
+    const auto countHighMileage = [this] {
+        int count = 0;
+        for (int slot = 0; slot < m_store.slotCount(); ++slot)
+            if (m_store.mileage(slot) > 5000) ++count;
+        return count;
+    };
+
+    QElapsedTimer timer;
+    timer.start();
+    int count = countHighMileage();
+    qInfo("Просмотр столбца: %.0f строк/с", FleetSize * 1000.0 / std::max<qint64>(timer.elapsed(), 1));
+
+    QBENCHMARK {
+        count = countHighMileage();
+    }
+    QVERIFY(count > 0);
+}
+
+void BenchFleet::radixSort_data()
+{
+    QTest::addColumn<int>("column");
+
+    QTest::newRow("год") << 0;
+    QTest::newRow("пробег") << 1;
+    QTest::newRow("стоимость") << 2;
+}
+
+void BenchFleet::radixSort()
+{
+    QFETCH(int, column);
+
+    // Ключи строятся так же, как в MachineTableModel
+    QVector<quint64> keys(SortSize);
+    for (int row = 0; row < SortSize; ++row) {
+        const int i = static_cast<int>(row * 7919LL % SortSize);
+        switch (column) {
+        case 0: keys[row] = SortEngine::orderedKey(qint64(2000 + i % 25)); break;
+        case 1: keys[row] = SortEngine::orderedKey(qint64(i * 37 % 20000)); break;
+        default: keys[row] = SortEngine::orderedKey(1000000.0 + (i % 1000) * 5000.0); break;
+        }
+    }
+
+    QVector<int> unsorted(SortSize);
+    std::iota(unsorted.begin(), unsorted.end(), 0);
+
+    QVector<int> rows;
+    QBENCHMARK {
+        rows = unsorted;
+        SortEngine::radixSort(rows, keys, false);
+    }
+    QVERIFY(std::ranges::is_sorted(rows, {}, [&](const int row) { return keys[row]; }));
+}
+
+void BenchFleet::parallelStableSort()
+{
+    QCollator collator{QLocale(QLocale::Russian)};
+    collator.setCaseSensitivity(Qt::CaseInsensitive);
+
+    QVector<QCollatorSortKey> keys;
+    keys.reserve(SortSize);
+    for (int row = 0; row < SortSize; ++row)
+        keys.append(collator.sortKey(QString("Машина %1").arg(row * 7919LL % SortSize)));
+
+    QVector<int> unsorted(SortSize);
+    std::iota(unsorted.begin(), unsorted.end(), 0);
+
+    const auto less = [&keys](const int a, const int b) { return keys[a].compare(keys[b]) < 0; };
+
+    QVector<int> rows;
+    QBENCHMARK {
+        rows = unsorted;
+        SortEngine::parallelStableSort(rows, less);
+    }
+    QVERIFY(std::ranges::is_sorted(rows, less));
+}
+
+void BenchFleet::filterEvaluate_data()
+{
+    QTest::addColumn<QString>("expression");
+
+    QTest::newRow("битовые карты") << QString("статус = Свободна и тип = Экскаватор");
+    QTest::newRow("составной") << QString("тип = Экскаватор и пробег > 5000 и обслуживание <= 30");
+    QTest::newRow("текст") << QString("название ~ 99 или серийный ~ 77");
+}
+
+void BenchFleet::filterEvaluate()
+{
+    QFETCH(QString, expression);
+
+    QString error;
+    const MachineFilter filter = MachineFilter::parse(expression, &error);
+    QVERIFY2(error.isEmpty(), qPrintable(error));
+
+    // Повторный расчёт фильтра над загруженным парком должен укладываться в 50 мс
+    qint64 best = std::numeric_limits<qint64>::max();
+    for (int run = 0; run < 5; ++run) {
+        QElapsedTimer timer;
+        timer.start();
+        QVERIFY(filter.evaluate(m_store).count() > 0);
+        best = std::min(best, timer.elapsed());
+    }
+    qInfo("Фильтр: %lld мс на %d машин", static_cast<long long>(best), FleetSize);
+    QVERIFY(best < 50);
+
+    QBENCHMARK {
+        filter.evaluate(m_store);
+    }
+}
+
+QTEST_GUILESS_MAIN(BenchFleet)
+#include "bench_fleet.moc"
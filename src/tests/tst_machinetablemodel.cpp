@@ -0,0 +1,57 @@
+#include <QTemporaryDir>
+#include <QtTest>
+#include "../database/FleetDatabase.h"
+#include "../ui/MachineTableModel.h"
+
+/**
+ * @brief Постраничная загрузка MachineTableModel на временной базе
+ */
+class TestMachineTableModel : public QObject {
+    Q_OBJECT
+
+private slots:
+    void initTestCase();
+    void cleanupTestCase();
+    void loadsPastPagesWithoutMatchingRows();
+
+private:
+    QTemporaryDir m_dir;
+};
+
+void TestMachineTableModel::initTestCase()
+{
+    QVERIFY(m_dir.isValid());
+    QVERIFY(FleetDatabase::instance().initialize(m_dir.filePath("fleet.db")));
+
+    // Две полные страницы свободной техники, за ними три машины в ремонте
+    const int available = 2 * MachineTableModel::PageSize;
+    QVector<MachinePtr> machines;
+    for (int i = 0; i < available + 3; ++i) {
+        auto machine = std::make_shared<Machine>(QString("Машина %1").arg(i), "Экскаватор",
+                                                 QString("SN-%1").arg(i), 2020, Money(1000000, Currency::RUB));
+        machine->setStatus(i < available ? MachineStatus::Available : MachineStatus::InRepair);
+        machines.append(machine);
+    }
+    QVERIFY(FleetDatabase::instance().addMachines(machines));
+}
+
+void TestMachineTableModel::cleanupTestCase()
+{
+    FleetDatabase::instance().close();
+}
+
+void TestMachineTableModel::loadsPastPagesWithoutMatchingRows()
+{
+    MachineTableModel model;
+    model.setLazyLoading(true);
+    model.setStatusFilter(3); // В ремонте
+    model.loadData();
+
+    // Представления здесь нет, и fetchMore() никто не вызывает - страницы
+    // без подходящих строк модель обязана дочитать сама
+    QTRY_COMPARE(model.rowCount(), 3);
+    QVERIFY(!model.canFetchMore(QModelIndex()));
+}
+
+QTEST_GUILESS_MAIN(TestMachineTableModel)
+#include "tst_machinetablemodel.moc"
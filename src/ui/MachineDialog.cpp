@@ -154,21 +154,9 @@ bool MachineDialog::validate()
 
 bool MachineDialog::isSerialNumberUnique(const QString& serialNumber)
 {
-    // Получаем все машины из БД
-    auto allMachines = FleetDatabase::instance().getAllMachines();
-    
-    // Проверяем, существует ли машина с таким серийным номером
-    for (const auto& machine : allMachines) {
-        if (machine->getSerialNumber() == serialNumber) {
-            // Если мы в режиме редактирования и это наша машина - ОК
-            if (m_isEditMode && m_machine && machine->getId() == m_machine->getId()) {
-                continue;
-            }
-            return false; // Найдена другая машина с таким номером
-        }
-    }
-    
-    return true; // Серийный номер уникален
+    // Своя запись в режиме редактирования не считается повтором
+    const int excludeId = m_isEditMode && m_machine ? m_machine->getId() : -1;
+    return !FleetDatabase::instance().serialNumberExists(serialNumber, excludeId);
 }
 
 void MachineDialog::accept()
@@ -1,14 +1,22 @@
 #include "MachineTableModel.h"
 #include "../database/FleetDatabase.h"
 #include "../models/Money.h"
+#include "../models/PerformanceLog.h"
+#include "../models/SortEngine.h"
 #include <QBrush>
 #include <QColor>
+#include <QDebug>
+#include <QElapsedTimer>
 #include <algorithm>
+#include <utility>
 
 MachineTableModel::MachineTableModel(QObject *parent)
     : QAbstractTableModel(parent)
     , m_currentStatusFilter(-1) // -1 означает показать все
+    , m_collator(QLocale(QLocale::Russian))
 {
+    m_collator.setCaseSensitivity(Qt::CaseInsensitive);
+
     m_headers << "Название" << "Статус" << "Текущий проект" << "Тип техники" << "Серийный номер" << "Год выпуска" << "Стоимость" << "Назначен с" << "Пробег" << "Дата обслуживания" << "Дата покупки" << "Гарантия";
 
     m_columnVisibility.resize(m_headers.size());
@@ -24,101 +32,109 @@ MachineTableModel::MachineTableModel(QObject *parent)
     m_columnVisibility[9] = false;  // Дата обслуживания
     m_columnVisibility[10] = false; // Дата покупки
     m_columnVisibility[11] = false; // Гарантия
+    rebuildColumnMap();
+    
+    connect(&FleetDatabase::instance(), &FleetDatabase::machineChanged,
+            this, &MachineTableModel::onMachineChanged);
+    connect(&FleetDatabase::instance(), &FleetDatabase::machinesReset,
+            this, &MachineTableModel::loadData);
+    connect(&FleetDatabase::instance(), &FleetDatabase::projectChanged,
+            this, &MachineTableModel::onProjectChanged);
+    connect(&FleetDatabase::instance(), &FleetDatabase::currencyRateChanged,
+            this, &MachineTableModel::onCurrencyRateChanged);
 }
 
 int MachineTableModel::rowCount(const QModelIndex &parent) const
 {
     if (parent.isValid()) return 0;
-    return m_machines.size();
+    return m_rows.size();
 }
 
 int MachineTableModel::columnCount(const QModelIndex &parent) const
 {
     if (parent.isValid()) return 0;
-    
-    int visibleCount = 0;
-    for (const bool visible : m_columnVisibility)
-        if (visible) visibleCount++;
-    return visibleCount;
+    return m_displayColumns.size();
 }
 
-int MachineTableModel::getActualColumnIndex(const int displayColumn) const
+void MachineTableModel::rebuildColumnMap()
 {
-    int visibleCount = 0;
+    m_displayColumns.clear();
     for (int i = 0; i < m_columnVisibility.size(); ++i)
-        if (m_columnVisibility[i]) {
-            if (visibleCount == displayColumn)
-                return i;
-            visibleCount++;
-        }
-    return -1;
+        if (m_columnVisibility[i]) m_displayColumns.append(i);
 }
 
 QVariant MachineTableModel::data(const QModelIndex &index, const int role) const
 {
-    if (!index.isValid() || index.row() >= m_machines.size())
+    if (!index.isValid() || index.row() >= m_rows.size())
         return QVariant();
 
     const int actualColumn = getActualColumnIndex(index.column());
     if (actualColumn == -1)
         return QVariant();
 
-    const auto machine = m_machines[index.row()];
-    
-    if (role == Qt::DisplayRole) {
-        switch (actualColumn) {
-            case 0: return machine->getName();
-            case 1: return Machine::statusToString(machine->getStatus());
-            case 2: return machine->getCurrentProject().isEmpty() ? "—" : machine->getCurrentProject();
-            case 3: return machine->getType();
-            case 4: return machine->getSerialNumber();
-            case 5: return QString::number(machine->getYearOfManufacture());
-            case 6: {
-                const Money cost = machine->getCost();
-                QString costText = cost.toString();
-                if (cost.getCurrency() != Currency::RUB) {
-                    const Money rubles = cost.convertTo(Currency::RUB);
-                    costText += QString(" (%1)").arg(rubles.toString());
-                }
-                return costText;
-            }
-            case 7: return machine->getAssignedDate().isValid() ? machine->getAssignedDate().toString("dd.MM.yyyy") : "—";
-            case 8: return QString::number(machine->getMileage()) + " км";
-            case 9: return machine->getNextMaintenanceDate().isValid() ? machine->getNextMaintenanceDate().toString("dd.MM.yyyy") : "—";
-            case 10: return machine->getPurchaseDate().isValid() ? machine->getPurchaseDate().toString("dd.MM.yyyy") : "—";
-            case 11: return QString("%1 месяцев").arg(machine->getWarrantyPeriod());
-            default: return QVariant();
-        }
-    }
+    const int slot = m_rows[index.row()];
     
-    if (role == Qt::BackgroundRole && actualColumn == 1)
-        switch (machine->getStatus()) {
-        case MachineStatus::Available:
-            return QBrush(QColor(76, 175, 80, 80)); // Зелёный (свободна)
-        case MachineStatus::OnSite:
-            return QBrush(QColor(33, 150, 243, 80)); // Синий (на объекте)
-        case MachineStatus::InRepair:
-            return QBrush(QColor(255, 152, 0, 80)); // Оранжевый (в ремонте)
-        case MachineStatus::Decommissioned:
-            return QBrush(QColor(244, 67, 54, 80)); // Красный (списана)
-        default: return QVariant();
-        }
+    if (role == Qt::DisplayRole)
+        return displayRow(slot).text[actualColumn];
+    
+    if (actualColumn != 1 || (role != Qt::BackgroundRole && role != Qt::ForegroundRole))
+        return QVariant();
+    
+    // Кисти статусов создаются один раз, индекс - значение MachineStatus
+    static const std::array<QBrush, MachineStatusCount> backgrounds = {
+        QBrush(QColor(76, 175, 80, 80)),   // Зелёный (свободна)
+        QBrush(QColor(33, 150, 243, 80)),  // Синий (на объекте)
+        QBrush(QColor(255, 152, 0, 80)),   // Оранжевый (в ремонте)
+        QBrush(QColor(244, 67, 54, 80))    // Красный (списана)
+    };
+    static const std::array<QBrush, MachineStatusCount> foregrounds = {
+        QBrush(QColor(76, 175, 80)),       // Зелёный
+        QBrush(QColor(33, 150, 243)),      // Синий
+        QBrush(QColor(255, 152, 0)),       // Оранжевый
+        QBrush(QColor(244, 67, 54))        // Красный
+    };
+    
+    const int status = Machine::statusToCode(m_store.status(slot));
+    return role == Qt::BackgroundRole ? backgrounds[status] : foregrounds[status];
+}
 
-    if (role == Qt::ForegroundRole && actualColumn == 1)
-        switch (machine->getStatus()) {
-        case MachineStatus::Available:
-            return QBrush(QColor(76, 175, 80)); // Зелёный
-        case MachineStatus::OnSite:
-            return QBrush(QColor(33, 150, 243)); // Синий
-        case MachineStatus::InRepair:
-            return QBrush(QColor(255, 152, 0)); // Оранжевый
-        case MachineStatus::Decommissioned:
-            return QBrush(QColor(244, 67, 54)); // Красный
-        default:
-            return QVariant();
-        }
+const MachineTableModel::RowDisplay& MachineTableModel::displayRow(const int slot) const
+{
+    if (const RowDisplay* cached = m_displayCache.object(slot))
+        return *cached;
+    
+    static const QString noValue = QStringLiteral("—");
+    const auto formatDate = [](const QDate& date) {
+        return date.isValid() ? date.toString(u"dd.MM.yyyy") : noValue;
+    };
+    
+    auto* row = new RowDisplay;
+    row->text[0] = m_store.name(slot);
+    row->text[1] = Machine::statusToString(m_store.status(slot));
+    row->text[2] = m_store.projectName(slot).isEmpty() ? noValue : m_store.projectName(slot);
+    row->text[3] = m_store.type(slot);
+    row->text[4] = m_store.serialNumber(slot);
+    row->text[5] = QString::number(m_store.yearOfManufacture(slot));
+    
+    const Money cost = m_store.cost(slot);
+    row->text[6] = cost.toString();
+    if (cost.getCurrency() != Currency::RUB)
+        row->text[6] += QString(" (%1)").arg(cost.convertTo(Currency::RUB).toString());
+    
+    row->text[7] = formatDate(m_store.assignedDate(slot));
+    row->text[8] = QString::number(m_store.mileage(slot)) + " км";
+    row->text[9] = formatDate(m_store.nextMaintenanceDate(slot));
+    row->text[10] = formatDate(m_store.purchaseDate(slot));
+    row->text[11] = QString("%1 месяцев").arg(m_store.warrantyPeriod(slot));
+    
+    // Кэш ограничен по числу строк и сам вытесняет давно не показанные
+    m_displayCache.insert(slot, row);
+    return *row;
+}
 
-    return QVariant();
+void MachineTableModel::clearDisplayCache()
+{
+    m_displayCache.clear();
 }
 
 QVariant MachineTableModel::headerData(const int section, const Qt::Orientation orientation, const int role) const
@@ -133,15 +149,133 @@ QVariant MachineTableModel::headerData(const int section, const Qt::Orientation
 
 void MachineTableModel::loadData()
 {
+    // Результаты запросов, отправленных до перезагрузки, отбрасываются
+    ++m_loadGeneration;
+    
     beginResetModel();
-    m_allMachines = FleetDatabase::instance().getAllMachines();
-    applyFilter();
+    m_store.clear();
+    m_rows.clear();
+    m_rowBySlot.clear();
+    clearDisplayCache();
+    m_textKeys.clear();
+    m_numberKeys.clear();
+    m_sortedSlots.clear();
+    m_lastLoadedId = 0;
+    m_hasMoreRows = false;
+    m_pendingInserts.clear();
+    m_searchOnlyIds.clear();
     endResetModel();
+    
+    // Отсортированный вид строится только по полному парку
+    requestRows(!m_lazyLoading || m_sortColumn >= 0);
+    
+    // Найденные машины могут быть за пределами первой страницы
+    if (!m_searchText.isEmpty()) requestSearch();
+}
+
+void MachineTableModel::setLazyLoading(const bool enabled)
+{
+    m_lazyLoading = enabled;
+}
+
+bool MachineTableModel::canFetchMore(const QModelIndex &parent) const
+{
+    if (parent.isValid()) return false;
+    return m_hasMoreRows && !m_fetchPending;
+}
+
+void MachineTableModel::fetchMore(const QModelIndex &parent)
+{
+    if (parent.isValid() || !canFetchMore(parent)) return;
+    requestRows(false);
+}
+
+void MachineTableModel::requestRows(const bool all)
+{
+    m_fetchPending = true;
+    
+    const int generation = m_loadGeneration;
+    const int limit = all ? -1 : PageSize;
+    
+    // Запрос выполняется в фоновом потоке, строки добавляются в GUI-потоке
+    FleetDatabase::instance().getMachinesPageAsync(m_lastLoadedId, limit, m_loadedCondition)
+        .then(this, [this, generation, limit](const QVector<MachinePtr>& rows) {
+            if (generation != m_loadGeneration) return;
+            m_fetchPending = false;
+            appendRows(rows, limit > 0 && rows.size() == limit);
+            insertPendingMachines();
+        });
+}
+
+void MachineTableModel::appendRows(const QVector<MachinePtr>& rows, const bool hasMoreRows)
+{
+    m_hasMoreRows = hasMoreRows;
+    
+    QVector<int> visible;
+    bool relocated = false;
+    for (const auto& machine : rows) {
+        // Машина, добавленная поиском, переходит на своё место в порядке загрузки
+        if (m_searchOnlyIds.remove(machine->getId())) {
+            dropSlot(m_store.slotOf(machine->getId()));
+            relocated = true;
+        }
+        
+        // Машина могла прийти раньше через уведомление об изменении
+        if (machine->getId() <= m_lastLoadedId || m_store.slotOf(machine->getId()) >= 0) continue;
+        const int slot = m_store.append(*machine);
+        storeSortKey(slot);
+        if (acceptsSlot(slot)) visible.append(slot);
+    }
+    if (!rows.isEmpty()) m_lastLoadedId = std::max(m_lastLoadedId, rows.last()->getId());
+    
+    if (!m_hasMoreRows && !m_store.isEmpty())
+        qCDebug(lcPerformance) << "Хранилище техники:" << m_store.size() << "машин,"
+                               << m_store.memoryUsage() / m_store.size() << "байт на машину";
+    
+    // Сортировка была включена во время загрузки страницы - дочитываем остальное
+    if (m_sortColumn >= 0 && m_hasMoreRows) requestRows(true);
+    
+    if (visible.isEmpty() && !relocated) {
+        // Ни одна строка страницы не прошла фильтр: вид не изменился, и
+        // представление само следующую страницу не запросит
+        if (m_hasMoreRows && !m_fetchPending) requestRows(false);
+        return;
+    }
+    
+    if (m_sortColumn >= 0 || relocated) {
+        // Новые строки встают в середину вида - пересобираем его целиком
+        beginResetModel();
+        applyFilter();
+        endResetModel();
+        return;
+    }
+    
+    // Без сортировки вид идёт в порядке ID - строки добавляются в конец
+    const int first = m_rows.size();
+    beginInsertRows(QModelIndex(), first, first + visible.size() - 1);
+    m_rows += visible;
+    indexRows(first);
+    endInsertRows();
+}
+
+void MachineTableModel::insertPendingMachines()
+{
+    const QMap<int, MachinePtr> pending = std::exchange(m_pendingInserts, {});
+    for (const MachinePtr& machine : pending) {
+        // Машина пришла вместе со страницей
+        if (m_store.slotOf(machine->getId()) >= 0) continue;
+        
+        // Следующий запрос выполнится после добавления и вернёт её сам
+        if (m_hasMoreRows && machine->getId() > m_lastLoadedId) continue;
+        
+        m_lastLoadedId = std::max(m_lastLoadedId, machine->getId());
+        insertSlot(*machine);
+    }
 }
 
 MachinePtr MachineTableModel::getMachine(const int row) const
 {
-    if (row >= 0 && row < m_machines.size()) return m_machines[row];
+    if (row >= 0 && row < m_rows.size()) return m_store.machine(m_rows[row]);
     return nullptr;
 }
 
@@ -153,30 +287,283 @@ void MachineTableModel::setStatusFilter(const int statusIndex)
     endResetModel();
 }
 
-void MachineTableModel::applyFilter()
+void MachineTableModel::setFilter(const MachineFilter& filter)
+{
+    m_filter = filter;
+    
+    // Хранилище уже загружено (или догружается) с тем же условием либо
+    // содержит весь парк - достаточно пересчитать вид в памяти
+    const SqlCondition condition = m_lazyLoading ? m_filter.sqlCondition() : SqlCondition();
+    const bool sameCondition = condition.where == m_loadedCondition.where
+                            && condition.bindings == m_loadedCondition.bindings;
+    if (sameCondition || (m_loadedCondition.where.isEmpty() && !m_hasMoreRows)) {
+        beginResetModel();
+        applyFilter();
+        endResetModel();
+        return;
+    }
+    
+    // Иначе загружаем заново только машины, отобранные индексами базы
+    m_loadedCondition = condition;
+    loadData();
+}
+
+void MachineTableModel::setSearchText(const QString& text)
+{
+    const QString searchText = text.simplified();
+    if (searchText == m_searchText) return;
+    m_searchText = searchText;
+    
+    if (!m_searchText.isEmpty()) {
+        requestSearch();
+        return;
+    }
+    
+    // Ответ на последний запрос поиска больше не нужен
+    ++m_searchGeneration;
+    m_searchIds.clear();
+    m_searchTruncated = false;
+    beginResetModel();
+    dropSearchOnlyMachines();
+    applyFilter();
+    endResetModel();
+}
+
+void MachineTableModel::requestSearch()
 {
-    m_machines.clear();
-    
-    if (m_currentStatusFilter == -1 || m_currentStatusFilter == 0)
-        m_machines = m_allMachines;
-    else {
-        MachineStatus targetStatus;
-        switch (m_currentStatusFilter) {
-            case 1: targetStatus = MachineStatus::Available; break;
-            case 2: targetStatus = MachineStatus::OnSite; break;
-            case 3: targetStatus = MachineStatus::InRepair; break;
-            case 4: targetStatus = MachineStatus::Decommissioned; break;
-            default:
-                m_machines = m_allMachines;
-                return;
+    const int generation = ++m_searchGeneration;
+    FleetDatabase::instance().searchMachinesAsync(m_searchText, SearchLimit)
+        .then(this, [this, generation](const QVector<MachinePtr>& machines) {
+            if (generation != m_searchGeneration) return;
+            applySearchResults(machines);
+        });
+}
+
+void MachineTableModel::applySearchResults(const QVector<MachinePtr>& machines)
+{
+    m_searchIds.clear();
+    for (const auto& machine : machines)
+        m_searchIds.insert(machine->getId());
+    m_searchTruncated = machines.size() >= SearchLimit;
+    
+    beginResetModel();
+    dropSearchOnlyMachines(m_searchIds);
+    for (const auto& machine : machines) {
+        // Машина из ещё не загруженной страницы хранится до отмены поиска
+        // или до загрузки её страницы
+        if (m_store.slotOf(machine->getId()) >= 0) continue;
+        storeSortKey(m_store.append(*machine));
+        m_searchOnlyIds.insert(machine->getId());
+    }
+    applyFilter();
+    endResetModel();
+}
+
+void MachineTableModel::dropSearchOnlyMachines(const QSet<int>& keep)
+{
+    for (auto it = m_searchOnlyIds.begin(); it != m_searchOnlyIds.end();) {
+        if (keep.contains(*it)) {
+            ++it;
+            continue;
         }
-        
-        for (const auto& machine : m_allMachines)
-            if (machine->getStatus() == targetStatus)
-                m_machines.append(machine);
+        dropSlot(m_store.slotOf(*it));
+        it = m_searchOnlyIds.erase(it);
+    }
+}
+
+void MachineTableModel::dropSlot(const int slot)
+{
+    m_store.remove(slot);
+    m_displayCache.remove(slot);
+}
+
+void MachineTableModel::applyFilter()
+{
+    QElapsedTimer timer;
+    timer.start();
+    
+    const Bitmap accepted = filterSlots();
+    m_rows.clear();
+    
+    if (m_sortColumn < 0) {
+        // Без сортировки вид идёт в порядке слотов (по ID)
+        accepted.appendSetBits(m_rows);
+    } else {
+        // Полный отсортированный порядок обновляется один раз на версию данных,
+        // фильтр только выбирает из него строки
+        if (m_sortedRevision != m_store.revision()) updateSortedSlots();
+        m_rows.reserve(accepted.count());
+        for (const int slot : std::as_const(m_sortedSlots))
+            if (accepted.test(slot)) m_rows.append(slot);
+    }
+    rebuildRowIndex();
+    
+    const qint64 elapsed = timer.nsecsElapsed();
+    if (elapsed > 0 && !m_store.isEmpty())
+        qCDebug(lcPerformance) << "Фильтр техники:" << m_store.size() << "машин за" << elapsed / 1000000.0 << "мс ("
+                               << qRound64(m_store.size() * 1e9 / elapsed) << "строк/с)";
+}
+
+Bitmap MachineTableModel::filterSlots() const
+{
+    Bitmap slots = m_filter.evaluate(m_store);
+    if (!m_searchText.isEmpty()) {
+        Bitmap found(m_store.slotCount());
+        for (const int id : m_searchIds)
+            if (const int slot = m_store.slotOf(id); slot >= 0) found.set(slot);
+        slots &= found;
+    }
+    switch (m_currentStatusFilter) {
+        case 1: return slots &= m_store.statusSlots(MachineStatus::Available);
+        case 2: return slots &= m_store.statusSlots(MachineStatus::OnSite);
+        case 3: return slots &= m_store.statusSlots(MachineStatus::InRepair);
+        case 4: return slots &= m_store.statusSlots(MachineStatus::Decommissioned);
+        default: return slots; // -1, 0 и неизвестные значения - показать все
+    }
+}
+
+bool MachineTableModel::acceptsSlot(const int slot) const
+{
+    const MachineStatus status = m_store.status(slot);
+    bool statusAccepted = true; // -1, 0 и неизвестные значения - показать все
+    switch (m_currentStatusFilter) {
+        case 1: statusAccepted = status == MachineStatus::Available; break;
+        case 2: statusAccepted = status == MachineStatus::OnSite; break;
+        case 3: statusAccepted = status == MachineStatus::InRepair; break;
+        case 4: statusAccepted = status == MachineStatus::Decommissioned; break;
+        default: break;
+    }
+    if (!statusAccepted) return false;
+    if (!m_searchText.isEmpty() && !m_searchIds.contains(m_store.id(slot))) return false;
+    return m_filter.accepts(m_store, slot);
+}
+
+bool MachineTableModel::lessThan(const int left, const int right) const
+{
+    // Для убывания меняем операнды местами, чтобы сохранить строгий слабый порядок
+    const int a = m_sortOrder == Qt::AscendingOrder ? left : right;
+    const int b = m_sortOrder == Qt::AscendingOrder ? right : left;
+    
+    if (m_sortKeysColumn < 0) return false;
+    if (isTextColumn(m_sortKeysColumn)) return m_textKeys[a].compare(m_textKeys[b]) < 0;
+    return m_numberKeys[a] < m_numberKeys[b];
+}
+
+void MachineTableModel::sortRows()
+{
+    updateSortedSlots();
+    
+    // Отображаемые строки - те же слоты в новом порядке
+    QVector<int> rows;
+    rows.reserve(m_rows.size());
+    for (const int slot : std::as_const(m_sortedSlots))
+        if (rowOfSlot(slot) >= 0) rows.append(slot);
+    m_rows = std::move(rows);
+    indexRows();
+}
+
+void MachineTableModel::updateSortedSlots()
+{
+    // Основа - прежний порядок: устойчивая сортировка оставляет равные по
+    // ключу строки в порядке предыдущих сортировок
+    const Bitmap& live = m_store.allSlots();
+    Bitmap ordered(m_store.slotCount());
+    QVector<int> slots;
+    slots.reserve(m_store.size());
+    for (const int slot : std::as_const(m_sortedSlots)) {
+        if (!live.test(slot)) continue; // Машина удалена
+        slots.append(slot);
+        ordered.set(slot);
     }
     
-    if (m_sortColumn >= 0) sort(m_sortColumn, m_sortOrder);
+    // Машины, добавленные после прошлой сортировки, - в порядке загрузки
+    for (int slot = 0; slot < m_store.slotCount(); ++slot)
+        if (live.test(slot) && !ordered.test(slot)) slots.append(slot);
+    
+    sortSlots(slots);
+    m_sortedSlots = std::move(slots);
+    m_sortedRevision = m_store.revision();
+}
+
+void MachineTableModel::indexRows(const int first, const int last)
+{
+    if (m_rowBySlot.size() < m_store.slotCount()) m_rowBySlot.resize(m_store.slotCount(), -1);
+    for (int row = first; row < last; ++row)
+        m_rowBySlot[m_rows[row]] = row;
+}
+
+void MachineTableModel::rebuildRowIndex()
+{
+    m_rowBySlot.fill(-1, m_store.slotCount());
+    indexRows();
+}
+
+void MachineTableModel::sortSlots(QVector<int>& slots) const
+{
+    if (m_sortKeysColumn < 0) return;
+    
+    // Числовые колонки и даты - поразрядная сортировка по ключам,
+    // текстовые - слияние на нескольких потоках по ключам сопоставления
+    if (isTextColumn(m_sortKeysColumn))
+        SortEngine::parallelStableSort(slots, [this](const int a, const int b) { return lessThan(a, b); });
+    else
+        SortEngine::radixSort(slots, m_numberKeys, m_sortOrder == Qt::DescendingOrder);
+}
+
+bool MachineTableModel::isTextColumn(const int column)
+{
+    // Название, текущий проект, тип техники, серийный номер
+    return column == 0 || column == 2 || column == 3 || column == 4;
+}
+
+void MachineTableModel::rebuildSortKeys()
+{
+    m_textKeys.clear();
+    m_numberKeys.clear();
+    
+    m_sortKeysColumn = m_sortColumn >= 0 && m_sortColumn < m_headers.size() ? m_sortColumn : -1;
+    if (m_sortKeysColumn < 0) return;
+    
+    if (isTextColumn(m_sortKeysColumn)) m_textKeys.reserve(m_store.slotCount());
+    else m_numberKeys.reserve(m_store.slotCount());
+    
+    for (int slot = 0; slot < m_store.slotCount(); ++slot)
+        storeSortKey(slot);
+}
+
+void MachineTableModel::storeSortKey(const int slot)
+{
+    if (m_sortKeysColumn < 0) return;
+    
+    if (isTextColumn(m_sortKeysColumn)) {
+        QCollatorSortKey key = [&] {
+            switch (m_sortKeysColumn) {
+            case 0: return m_collator.sortKey(m_store.name(slot));
+            case 2: return m_collator.sortKey(m_store.projectName(slot));
+            case 3: return m_collator.sortKey(m_store.type(slot));
+            default: return m_collator.sortKey(m_store.serialNumber(slot));
+            }
+        }();
+        if (slot == m_textKeys.size()) m_textKeys.append(std::move(key));
+        else m_textKeys[slot] = std::move(key);
+        return;
+    }
+    
+    // Пустая дата даёт минимальный номер дня и идёт первой, как при сравнении QDate
+    quint64 key = 0;
+    switch (m_sortKeysColumn) {
+    case 1: key = SortEngine::orderedKey(qint64(Machine::statusToCode(m_store.status(slot)))); break;
+    case 5: key = SortEngine::orderedKey(qint64(m_store.yearOfManufacture(slot))); break;
+    case 6: key = SortEngine::orderedKey(m_store.cost(slot).toRubles()); break;
+    case 7: key = SortEngine::orderedKey(m_store.assignedDate(slot).toJulianDay()); break;
+    case 8: key = SortEngine::orderedKey(qint64(m_store.mileage(slot))); break;
+    case 9: key = SortEngine::orderedKey(m_store.nextMaintenanceDate(slot).toJulianDay()); break;
+    case 10: key = SortEngine::orderedKey(m_store.purchaseDate(slot).toJulianDay()); break;
+    case 11: key = SortEngine::orderedKey(qint64(m_store.warrantyPeriod(slot))); break;
+    default: break;
+    }
+    if (slot == m_numberKeys.size()) m_numberKeys.append(key);
+    else m_numberKeys[slot] = key;
 }
 
 void MachineTableModel::sort(const int column, Qt::SortOrder order)
@@ -187,52 +574,224 @@ void MachineTableModel::sort(const int column, Qt::SortOrder order)
 
     m_sortColumn = actualColumn;
     m_sortOrder = order;
+    if (m_sortKeysColumn != m_sortColumn) rebuildSortKeys();
+    
+    // Для сортировки нужен весь парк - дочитываем оставшиеся страницы,
+    // а пока сортируем уже загруженные строки
+    if (m_hasMoreRows && !m_fetchPending) requestRows(true);
     
     emit layoutAboutToBeChanged();
+    sortRows();
+    emit layoutChanged();
+}
+
+int MachineTableModel::getRowById(const int machineId) const
+{
+    const int slot = m_store.slotOf(machineId);
+    if (slot < 0) return -1;
+    return rowOfSlot(slot);
+}
+
+void MachineTableModel::onMachineChanged(const ChangeEvent& event)
+{
+    if (event.operation == ChangeEvent::Operation::Deleted) {
+        removeMachine(event.id);
+        return;
+    }
     
-    std::ranges::sort(m_machines,
-        [actualColumn, order](const MachinePtr& a, const MachinePtr& b) {
-            bool result = false;
-            switch (actualColumn) {
-            case 0: // Название
-                result = a->getName().toLower() < b->getName().toLower();
-                break;
-            case 1: // Статус
-                result = static_cast<int>(a->getStatus()) < static_cast<int>(b->getStatus());
-                break;
-            case 2: // Текущий проект
-                result = a->getCurrentProject().toLower() < b->getCurrentProject().toLower();
-                break;
-            case 3: // Тип техники
-                result = a->getType().toLower() < b->getType().toLower();
-                break;
-            case 4: // Серийный номер
-                result = a->getSerialNumber().toLower() < b->getSerialNumber().toLower();
-                break;
-            case 5: // Год выпуска
-                result = a->getYearOfManufacture() < b->getYearOfManufacture();
-                break;
-            case 6: // Стоимость
-                result = a->getCost().toRubles() < b->getCost().toRubles();
-                break;
-            case 7: // Назначен с
-                result = a->getAssignedDate() < b->getAssignedDate();
-                break;
-            default:
-                return false;
-            }
-            return order == Qt::AscendingOrder ? result : !result;
-        });
+    const MachinePtr machine = FleetDatabase::instance().getMachineById(event.id);
+    if (!machine) return;
+    
+    if (event.operation == ChangeEvent::Operation::Inserted) insertMachine(machine);
+    else updateMachine(machine);
+    
+    // Изменение индексируемых полей может изменить результаты поиска
+    if (m_searchText.isEmpty()) return;
+    const bool searchable = event.operation == ChangeEvent::Operation::Inserted
+        || (event.fields & (ChangeEvent::Name | ChangeEvent::Type
+                            | ChangeEvent::SerialNumber | ChangeEvent::CurrentProject));
+    if (searchable) requestSearch();
+}
+
+void MachineTableModel::onProjectChanged(const ChangeEvent& event)
+{
+    // Название проекта хранится только в projects - переименование
+    // подставляем в уже загруженные строки
+    if (event.operation != ChangeEvent::Operation::Updated
+        || !event.fields.testFlag(ChangeEvent::ProjectName))
+        return;
+    
+    // Название проекта входит в полнотекстовый индекс техники
+    if (!m_searchText.isEmpty()) requestSearch();
+    
+    const ProjectPtr project = FleetDatabase::instance().getProjectById(event.id);
+    if (!project) return;
     
+    if (!m_store.renameProject(event.id, project->getName())) return;
+    clearDisplayCache();
+    if (m_rows.isEmpty()) return;
+    
+    if (m_sortColumn == 2) {
+        rebuildSortKeys();
+        emit layoutAboutToBeChanged();
+        sortRows();
+        emit layoutChanged();
+        return;
+    }
+    
+    emit dataChanged(index(0, 0), index(m_rows.size() - 1, columnCount() - 1));
+}
+
+void MachineTableModel::onCurrencyRateChanged()
+{
+    // Стоимость в рублях в кэше отображения и в ключах посчитана по старому курсу
+    clearDisplayCache();
+    
+    const int costColumn = static_cast<int>(m_displayColumns.indexOf(6));
+    if (costColumn >= 0 && !m_rows.isEmpty())
+        emit dataChanged(index(0, costColumn), index(m_rows.size() - 1, costColumn), {Qt::DisplayRole});
+    
+    if (m_sortColumn != 6) return;
+    
+    rebuildSortKeys();
+    emit layoutAboutToBeChanged();
+    sortRows();
     emit layoutChanged();
 }
 
-int MachineTableModel::getRowById(const int machineId) const
+int MachineTableModel::insertionRow(const int slot) const
+{
+    // Без сортировки строки идут в порядке загрузки (по ID) - новая в конец
+    if (m_sortColumn < 0) return m_rows.size();
+    
+    const auto it = std::upper_bound(m_rows.cbegin(), m_rows.cend(), slot,
+        [this](const int a, const int b) { return lessThan(a, b); });
+    return static_cast<int>(it - m_rows.cbegin());
+}
+
+void MachineTableModel::insertMachine(const MachinePtr& machine)
 {
-    for (int i = 0; i < m_machines.size(); ++i)
-        if (m_machines[i]->getId() == machineId)
-            return i;
-    return -1;
+    if (!machine) return;
+    
+    // Машина, добавленная поиском, встаёт на место по порядку загрузки
+    if (m_searchOnlyIds.contains(machine->getId())) removeMachine(machine->getId());
+    
+    // Машина уже загружена
+    if (m_store.slotOf(machine->getId()) >= 0) {
+        updateMachine(machine);
+        return;
+    }
+    
+    if (machine->getId() > m_lastLoadedId) {
+        // Выполняющийся запрос мог прочитать базу до добавления машины -
+        // решаем по его ответу
+        if (m_fetchPending) {
+            m_pendingInserts.insert(machine->getId(), machine);
+            return;
+        }
+        
+        // Машина за пределами загруженных страниц придёт вместе со своей страницей
+        if (m_hasMoreRows) return;
+    }
+    
+    m_lastLoadedId = std::max(m_lastLoadedId, machine->getId());
+    insertSlot(*machine);
+}
+
+void MachineTableModel::insertSlot(const Machine& machine)
+{
+    const int slot = m_store.append(machine);
+    storeSortKey(slot);
+    if (!acceptsSlot(slot)) return;
+    
+    const int row = insertionRow(slot);
+    beginInsertRows(QModelIndex(), row, row);
+    m_rows.insert(row, slot);
+    indexRows(row);
+    endInsertRows();
+}
+
+void MachineTableModel::updateMachine(const MachinePtr& machine)
+{
+    if (!machine) return;
+    
+    const int slot = m_store.slotOf(machine->getId());
+    if (slot < 0) {
+        insertMachine(machine);
+        return;
+    }
+    m_store.assign(slot, *machine);
+    m_displayCache.remove(slot);
+    storeSortKey(slot);
+    
+    const int row = rowOfSlot(slot);
+    const bool visible = acceptsSlot(slot);
+    
+    // Строка появилась в фильтре или пропала из него
+    if (row < 0) {
+        if (visible) {
+            const int newRow = insertionRow(slot);
+            beginInsertRows(QModelIndex(), newRow, newRow);
+            m_rows.insert(newRow, slot);
+            indexRows(newRow);
+            endInsertRows();
+        }
+        return;
+    }
+    if (!visible) {
+        beginRemoveRows(QModelIndex(), row, row);
+        m_rows.remove(row);
+        m_rowBySlot[slot] = -1;
+        indexRows(row);
+        endRemoveRows();
+        return;
+    }
+    
+    // Если строка нарушила порядок сортировки - перемещаем её на новое место
+    int targetRow = row;
+    if (m_sortColumn >= 0) {
+        const auto less = [this](const int a, const int b) { return lessThan(a, b); };
+        const auto begin = m_rows.begin();
+        
+        if (row > 0 && lessThan(slot, m_rows[row - 1])) {
+            const int destination = static_cast<int>(std::upper_bound(begin, begin + row, slot, less) - begin);
+            beginMoveRows(QModelIndex(), row, row, QModelIndex(), destination);
+            std::rotate(begin + destination, begin + row, begin + row + 1);
+            indexRows(destination, row + 1);
+            endMoveRows();
+            targetRow = destination;
+        } else if (row + 1 < m_rows.size() && lessThan(m_rows[row + 1], slot)) {
+            const int destination = static_cast<int>(std::upper_bound(begin + row + 1, m_rows.end(), slot, less) - begin);
+            beginMoveRows(QModelIndex(), row, row, QModelIndex(), destination);
+            std::rotate(begin + row, begin + row + 1, begin + destination);
+            indexRows(row, destination);
+            endMoveRows();
+            targetRow = destination - 1;
+        }
+    }
+    
+    emit dataChanged(index(targetRow, 0), index(targetRow, columnCount() - 1));
+}
+
+void MachineTableModel::removeMachine(const int machineId)
+{
+    m_pendingInserts.remove(machineId);
+    m_searchOnlyIds.remove(machineId);
+    
+    const int slot = m_store.slotOf(machineId);
+    if (slot < 0) return;
+    
+    const int row = rowOfSlot(slot);
+    if (row >= 0) beginRemoveRows(QModelIndex(), row, row);
+    
+    // Слот остаётся пустым, остальные слоты вида и кэша не меняются
+    dropSlot(slot);
+    if (row >= 0) {
+        m_rows.remove(row);
+        m_rowBySlot[slot] = -1;
+        indexRows(row);
+        endRemoveRows();
+    }
 }
 
 void MachineTableModel::setColumnVisible(const int column, const bool visible)
@@ -241,9 +800,18 @@ void MachineTableModel::setColumnVisible(const int column, const bool visible)
 
     if (m_columnVisibility[column] == visible) return;
 
-    beginResetModel();
+    // Позиция колонки среди видимых - число видимых колонок левее неё
+    const int displayColumn = static_cast<int>(std::lower_bound(m_displayColumns.cbegin(), m_displayColumns.cend(), column)
+                                               - m_displayColumns.cbegin());
+    
+    if (visible) beginInsertColumns(QModelIndex(), displayColumn, displayColumn);
+    else beginRemoveColumns(QModelIndex(), displayColumn, displayColumn);
+    
     m_columnVisibility[column] = visible;
-    endResetModel();
+    rebuildColumnMap();
+    
+    if (visible) endInsertColumns();
+    else endRemoveColumns();
 }
 
 bool MachineTableModel::isColumnVisible(const int column) const
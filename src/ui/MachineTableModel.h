@@ -1,19 +1,36 @@
 #pragma once
 
 #include <QAbstractTableModel>
+#include <QCache>
 #include "../models/Machine.h"
+#include "../models/FleetStore.h"
+#include "../models/MachineFilter.h"
+#include <QCollator>
+#include <QCollatorSortKey>
+#include <QMap>
+#include <QSet>
 #include <QVector>
+#include <array>
+
+struct ChangeEvent;
 
 /**
  * @brief Модель таблицы для отображения списка техники
  * 
  * Реализует QAbstractTableModel для управления данными в QTableView.
- * Поддерживает фильтрацию по статусу техники.
+ * Поддерживает фильтрацию по статусу техники. Подписана на изменения
+ * FleetDatabase и обновляет только затронутые строки.
+ *
+ * Загруженный парк хранится по столбцам в FleetStore, отображаемые строки -
+ * вектор слотов хранилища в порядке вывода.
  */
 class MachineTableModel : public QAbstractTableModel {
     Q_OBJECT
 
 public:
+    // Размер страницы при постраничной загрузке
+    static constexpr int PageSize = 2000;
+    
     /**
      * @brief Конструктор модели таблицы
      * @param parent Родительский объект
@@ -26,14 +43,56 @@ public:
     QVariant data(const QModelIndex &index, int role = Qt::DisplayRole) const override;
     QVariant headerData(int section, Qt::Orientation orientation, int role = Qt::DisplayRole) const override;
     void sort(int column, Qt::SortOrder order = Qt::AscendingOrder) override;
+    bool canFetchMore(const QModelIndex &parent) const override;
+    void fetchMore(const QModelIndex &parent) override;
     
     /**
      * @brief Загрузить данные из базы
+     *
+     * Модель сбрасывается сразу, строки приходят асинхронно из фонового
+     * потока. В режиме постраничной загрузки запрашивается только первая
+     * страница, остальные подгружаются через fetchMore() по мере прокрутки.
      */
     void loadData();
     
+    /**
+     * @brief Включить постраничную загрузку (keyset-пагинация по id)
+     *
+     * Действует со следующего вызова loadData(). При сортировке
+     * догружаются все оставшиеся страницы, так как порядок по колонке
+     * нельзя построить по части парка.
+     * @param enabled true - загружать страницами, false - всё сразу
+     */
+    void setLazyLoading(bool enabled);
+    
+    /**
+     * @brief Добавить в модель одну новую машину без перезагрузки
+     *
+     * Строка вставляется с учётом текущих фильтра и сортировки.
+     * @param machine Машина, уже сохранённая в базе
+     */
+    void insertMachine(const MachinePtr& machine);
+    
+    /**
+     * @brief Обновить одну машину в модели без перезагрузки
+     *
+     * Строка обновляется на месте, перемещается при нарушении порядка
+     * сортировки, добавляется или убирается при смене видимости по фильтру.
+     * @param machine Машина с актуальными данными
+     */
+    void updateMachine(const MachinePtr& machine);
+    
+    /**
+     * @brief Удалить одну машину из модели без перезагрузки
+     * @param machineId ID техники
+     */
+    void removeMachine(int machineId);
+    
     /**
      * @brief Получить машину по индексу строки
+     *
+     * Объект собирается из хранилища: изменения в нём не попадают в модель,
+     * пока не будут сохранены в базе.
      * @param row Номер строки
      * @return Указатель на объект Machine или nullptr
      */
@@ -45,6 +104,36 @@ public:
      */
     void setStatusFilter(int statusIndex);
     
+    /**
+     * @brief Установить составной фильтр (действует вместе с фильтром по статусу)
+     *
+     * Если парк загружен целиком, фильтр применяется к строкам в памяти.
+     * Иначе модель перезагружается, и индексируемая часть фильтра
+     * выполняется в запросе к базе.
+     * @param filter Разобранный фильтр (пустой - без условий)
+     */
+    void setFilter(const MachineFilter& filter);
+    
+    /**
+     * @brief Текущий составной фильтр
+     */
+    const MachineFilter& filter() const { return m_filter; }
+    
+    /**
+     * @brief Показать только технику, найденную полнотекстовым поиском
+     *
+     * Поиск выполняется в фоновом потоке по индексу FTS5; найденные
+     * машины, ещё не загруженные постранично, добавляются в хранилище до
+     * отмены поиска или загрузки их страницы. Действует вместе с фильтрами.
+     * @param text Строка поиска (пустая - отключить поиск)
+     */
+    void setSearchText(const QString& text);
+    
+    /**
+     * @brief Показаны не все совпадения: поиск упёрся в ограничение числа результатов
+     */
+    bool isSearchTruncated() const { return m_searchTruncated; }
+    
     /**
      * @brief Получить индекс строки по ID техники
      * @param machineId ID техники
@@ -54,6 +143,8 @@ public:
     
     /**
      * @brief Установить видимость колонки
+     *
+     * Колонка вставляется или удаляется из вида без сброса модели.
      * @param column Номер колонки
      * @param visible true - показать, false - скрыть
      */
@@ -78,9 +169,188 @@ private:
      */
     void applyFilter();
     
-    QVector<MachinePtr> m_allMachines;      // Все машины
-    QVector<MachinePtr> m_machines;          // Отфильтрованные машины (отображаемые)
+    /**
+     * @brief Применить изменение техники из FleetDatabase к модели
+     * @param event Описание изменения
+     */
+    void onMachineChanged(const ChangeEvent& event);
+    
+    /**
+     * @brief Подставить новое название проекта в загруженные строки
+     * @param event Описание изменения проекта
+     */
+    void onProjectChanged(const ChangeEvent& event);
+    
+    /**
+     * @brief Обновить стоимость в рублях после смены курса валют
+     */
+    void onCurrencyRateChanged();
+    
+    /**
+     * @brief Проходит ли машина в слоте текущие фильтры
+     */
+    bool acceptsSlot(int slot) const;
+    
+    /**
+     * @brief Сравнение слотов по текущим колонке и порядку сортировки
+     */
+    bool lessThan(int left, int right) const;
+    
+    /**
+     * @brief Отсортировать отображаемые строки по текущей колонке
+     */
+    void sortRows();
+    
+    /**
+     * @brief Пересортировать m_sortedSlots по текущим колонке и порядку,
+     * взяв за основу предыдущий порядок
+     */
+    void updateSortedSlots();
+    
+    /**
+     * @brief Отсортировать слоты по текущим колонке и порядку
+     */
+    void sortSlots(QVector<int>& slots) const;
+    
+    /**
+     * @brief Слоты, проходящие текущий фильтр, по битовым картам хранилища
+     */
+    Bitmap filterSlots() const;
+    
+    /**
+     * @brief Является ли колонка текстовой (сортируется по ключам сопоставления)
+     */
+    static bool isTextColumn(int column);
+    
+    /**
+     * @brief Построить ключи сортировки всех слотов для текущей колонки
+     */
+    void rebuildSortKeys();
+    
+    /**
+     * @brief Записать ключ сортировки слота (новый слот - в конец)
+     */
+    void storeSortKey(int slot);
+    
+    /**
+     * @brief Записать номера строк m_rows[first..last) в индекс слот -> строка
+     */
+    void indexRows(int first, int last);
+    void indexRows(int first = 0) { indexRows(first, static_cast<int>(m_rows.size())); }
+    
+    /**
+     * @brief Построить индекс слот -> строка заново по всему виду
+     */
+    void rebuildRowIndex();
+    
+    /**
+     * @brief Номер строки слота в виде (-1, если слот не отображается)
+     */
+    int rowOfSlot(int slot) const { return m_rowBySlot.value(slot, -1); }
+    
+    /**
+     * @brief Номер строки, в которую нужно вставить слот с учётом сортировки
+     */
+    int insertionRow(int slot) const;
+    
+    /**
+     * @brief Добавить машину в хранилище и, если она проходит фильтр, в вид
+     */
+    void insertSlot(const Machine& machine);
+    
+    /**
+     * @brief Запросить в фоновом потоке результаты поиска по m_searchText
+     */
+    void requestSearch();
+    
+    /**
+     * @brief Ограничить вид найденными машинами
+     * @param machines Результаты поиска
+     */
+    void applySearchResults(const QVector<MachinePtr>& machines);
+    
+    /**
+     * @brief Убрать из хранилища машины, добавленные только поиском
+     * @param keep ID машин, которые нужно оставить
+     */
+    void dropSearchOnlyMachines(const QSet<int>& keep = {});
+    
+    /**
+     * @brief Освободить слот хранилища и его строку в кэше отображения
+     */
+    void dropSlot(int slot);
+    
+    /**
+     * @brief Запросить в фоновом потоке строки после последней загруженной
+     * @param all true - все оставшиеся строки, false - одну страницу
+     */
+    void requestRows(bool all);
+    
+    /**
+     * @brief Добавить пришедшие из базы строки в модель
+     * @param rows Строки, упорядоченные по ID
+     * @param hasMoreRows Остались ли в базе незагруженные строки
+     */
+    void appendRows(const QVector<MachinePtr>& rows, bool hasMoreRows);
+    
+    /**
+     * @brief Добавить машины, созданные во время выполнения запроса строк
+     *
+     * Запрос мог прочитать базу до их добавления, поэтому решение
+     * откладывается до его ответа: машины, которые не пришли со страницей
+     * и не придут со следующей, вставляются по одной.
+     */
+    void insertPendingMachines();
+    
+    // Количество колонок таблицы (включая скрытые)
+    static constexpr int ColumnCount = 12;
+    
+    // Сколько строк держит кэш отображения (видимая область и запас прокрутки)
+    static constexpr int DisplayCacheRows = 4096;
+    
+    /**
+     * @brief Отформатированный текст всех колонок одной машины
+     */
+    struct RowDisplay {
+        std::array<QString, ColumnCount> text;
+    };
+    
+    /**
+     * @brief Текст строки для DisplayRole, форматируется при первом обращении
+     * @param slot Слот хранилища
+     */
+    const RowDisplay& displayRow(int slot) const;
+    
+    /**
+     * @brief Сбросить кэш отображения всех строк
+     */
+    void clearDisplayCache();
+    
+    // Слот -> отформатированная строка. Слот сбрасывается при изменении
+    // машины, весь кэш - при переименовании проекта и смене курса
+    mutable QCache<int, RowDisplay> m_displayCache{DisplayCacheRows};
+    
+    bool m_lazyLoading = false;              // Режим постраничной загрузки
+    bool m_hasMoreRows = false;              // В базе остались незагруженные строки
+    int m_lastLoadedId = 0;                  // ID последней загруженной машины
+    bool m_fetchPending = false;             // Запрос строк выполняется в фоновом потоке
+    int m_loadGeneration = 0;                // Номер загрузки для отбрасывания устаревших ответов
+    QMap<int, MachinePtr> m_pendingInserts;  // Машины, добавленные во время запроса строк (по ID)
+    
+    FleetStore m_store;                      // Все загруженные машины по столбцам
+    QVector<int> m_rows;                     // Слоты отображаемых машин в порядке вывода
+    QVector<int> m_rowBySlot;                // Слот -> номер строки в m_rows (-1 - не отображается)
     int m_currentStatusFilter;               // Текущий фильтр (-1 = все)
+    MachineFilter m_filter;                  // Составной фильтр
+    SqlCondition m_loadedCondition;          // Условие, с которым загружено хранилище
+    
+    // Полнотекстовый поиск
+    static constexpr int SearchLimit = 1000; // Максимум результатов поиска
+    QString m_searchText;                    // Пусто - поиск не действует
+    QSet<int> m_searchIds;                   // ID найденных машин
+    QSet<int> m_searchOnlyIds;               // Найденные машины за пределами загруженных страниц
+    bool m_searchTruncated = false;          // Результатов больше SearchLimit
+    int m_searchGeneration = 0;              // Номер запроса для отбрасывания устаревших ответов
     
     // Заголовки столбцов
     QStringList m_headers;
@@ -89,13 +359,36 @@ private:
     int m_sortColumn = -1;
     Qt::SortOrder m_sortOrder = Qt::AscendingOrder;
     
+    // Ключи сортировки по слотам хранилища, строятся один раз для колонки
+    // и обновляются вместе со слотами - компаратор не создаёт строк
+    QCollator m_collator;                    // Сравнение по правилам русской локали без учёта регистра
+    int m_sortKeysColumn = -1;               // Колонка, для которой построены ключи
+    QVector<QCollatorSortKey> m_textKeys;    // Ключи текстовых колонок
+    QVector<quint64> m_numberKeys;           // Ключи числовых колонок и дат (SortEngine::orderedKey)
+    
+    // Все слоты в порядке текущей сортировки: смена фильтра выбирает из них
+    // подходящие по битовой карте без повторной сортировки. Каждая следующая
+    // сортировка начинается с этого порядка, так что прежние сортировки
+    // сохраняются как вторичные ключи
+    QVector<int> m_sortedSlots;
+    quint64 m_sortedRevision = 0;            // Версия хранилища, для которой построен m_sortedSlots
+    
     // Видимость столбцов (индекс -> видимость)
     QVector<bool> m_columnVisibility;
     
+    // Реальные индексы видимых колонок по порядку вывода, пересчитываются
+    // только при смене видимости
+    QVector<int> m_displayColumns;
+    
+    /**
+     * @brief Пересчитать m_displayColumns по m_columnVisibility
+     */
+    void rebuildColumnMap();
+    
     /**
      * @brief Получить реальный индекс колонки с учётом скрытых колонок
      * @param displayColumn Видимый индекс колонки
      * @return Реальный индекс колонки (-1 если не найдено)
      */
-    int getActualColumnIndex(int displayColumn) const;
+    int getActualColumnIndex(int displayColumn) const { return m_displayColumns.value(displayColumn, -1); }
 };
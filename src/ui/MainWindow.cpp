@@ -13,14 +13,17 @@
 #include <QLabel>
 #include <QPushButton>
 #include <QComboBox>
+#include <QLineEdit>
+#include <QStyle>
 #include <QGroupBox>
 #include <QHeaderView>
 #include <QMessageBox>
 #include <QMenu>
 #include <QDebug>
 #include <QStackedWidget>
+#include <QStatusBar>
 #include <QSplitter>
-#include <QSignalBlocker>
+#include <QTimer>
 #include <tuple>
 
 MainWindow::MainWindow(QWidget *parent)
@@ -119,6 +122,7 @@ void MainWindow::setupTable()
 {
     // Создаём модель таблицы
     m_tableModel = new MachineTableModel(this);
+    m_tableModel->setLazyLoading(true); // Строки подгружаются по мере прокрутки
     
     // Создаём представление таблицы
     m_tableView = new QTableView();
@@ -198,8 +202,8 @@ void MainWindow::setupProjectsTable()
     
     m_projectTableView->setColumnWidth(0, 50);  // ID
     m_projectTableView->setColumnWidth(1, 300); // Название
-    m_projectTableView->setColumnWidth(2, 150); // Дата начала
-    m_projectTableView->setColumnWidth(3, 150); // Дата окончания
+    m_projectTableView->setColumnWidth(2, 300); // Описание
+    m_projectTableView->setColumnWidth(3, 90);  // Техника
     
     m_projectTableView->setContextMenuPolicy(Qt::CustomContextMenu);
     connect(m_projectTableView, &QTableView::customContextMenuRequested,
@@ -243,6 +247,31 @@ void MainWindow::connectSignals()
     
     // Подключаем фильтр по статусу
     connect(ui->statusFilter, QOverload<int>::of(&QComboBox::currentIndexChanged), this, &MainWindow::onStatusFilterChanged);
+    
+    // Составной фильтр применяется по Enter или при уходе фокуса из поля
+    ui->filterExpression->setToolTip("Условия через \"и\" / \"или\": поле оператор значение\n"
+                                     "Поля: название, тип, серийный, статус, проект, год, пробег,\n"
+                                     "стоимость, гарантия, обслуживание (дней до обслуживания)\n"
+                                     "Операторы: = != < <= > >= ~ (содержит)");
+    connect(ui->filterExpression, &QLineEdit::editingFinished, this, &MainWindow::onFilterExpressionChanged);
+    connect(ui->filterExpression, &QLineEdit::textChanged, this, [this](const QString& text) {
+        if (text.isEmpty()) onFilterExpressionChanged(); // Кнопка очистки
+    });
+    
+    // Поиск запускается после паузы в наборе, чтобы не искать на каждую букву
+    m_searchTimer = new QTimer(this);
+    m_searchTimer->setSingleShot(true);
+    m_searchTimer->setInterval(150);
+    connect(m_searchTimer, &QTimer::timeout, this, &MainWindow::onSearchTextChanged);
+    connect(ui->searchEdit, &QLineEdit::textChanged, m_searchTimer, qOverload<>(&QTimer::start));
+    
+    // Результаты поиска приходят из фонового потока
+    connect(m_tableModel, &QAbstractItemModel::modelReset, this, &MainWindow::updateStatusBar);
+    
+    // Подписываемся на изменения данных (модели таблиц подписаны раньше и уже обновлены)
+    connect(&FleetDatabase::instance(), &FleetDatabase::machineChanged, this, &MainWindow::onMachineChanged);
+    connect(&FleetDatabase::instance(), &FleetDatabase::projectChanged, this, &MainWindow::onProjectChanged);
+    connect(&FleetDatabase::instance(), &FleetDatabase::machinesReset, this, &MainWindow::onMachinesReset);
 
 }
 
@@ -279,6 +308,8 @@ void MainWindow::showFleetView()
     ui->btnFleet->setStyleSheet(activeStyle);
     ui->btnProjects->setStyleSheet(inactiveStyle);
     ui->statusFilter->setEnabled(true);
+    ui->filterExpression->setEnabled(true);
+    ui->searchEdit->setEnabled(true);
     updateStatusBar();
     updateToolbarButtonsState();
 }
@@ -316,6 +347,8 @@ void MainWindow::showProjectsView()
     ui->btnProjects->setStyleSheet(activeStyle);
     ui->btnFleet->setStyleSheet(inactiveStyle);
     ui->statusFilter->setEnabled(false);
+    ui->filterExpression->setEnabled(false);
+    ui->searchEdit->setEnabled(false);
     updateStatusBar();
     updateToolbarButtonsState();
 }
@@ -325,13 +358,12 @@ void MainWindow::onAddMachine()
     MachineDialog dialog(this);
     if (dialog.exec() == QDialog::Accepted) {
         const auto machine = dialog.getMachine();
-        if (FleetDatabase::instance().addMachine(machine)) {
-            m_tableModel->loadData();
-            updateStatusBar();
-            updateToolbarButtonsState();
-            QMessageBox::information(this, "Добавление",
-                                   QString("Техника \"%1\" успешно добавлена").arg(machine->getName()));
-        } else QMessageBox::critical(this, "Ошибка", "Не удалось добавить технику в базу данных");
+        FleetDatabase::instance().addMachineAsync(machine).then(this, [this, name = machine->getName()](const int id) {
+            if (id > 0) {
+                QMessageBox::information(this, "Добавление",
+                                       QString("Техника \"%1\" успешно добавлена").arg(name));
+            } else QMessageBox::critical(this, "Ошибка", "Не удалось добавить технику в базу данных");
+        });
     }
 }
 
@@ -343,24 +375,18 @@ void MainWindow::onEditMachine()
         return;
     }
     
-    int selectedMachineId = machine->getId();
-    
     MachineDialog dialog(this, machine);
     if (dialog.exec() == QDialog::Accepted) {
         const auto updatedMachine = dialog.getMachine();
-        if (FleetDatabase::instance().updateMachine(updatedMachine)) {
-            // Временно отключаем сигналы от выбора для предотвращения обновления panels during reload
-            const QSignalBlocker blocker(m_tableView->selectionModel());
-            
-            m_tableModel->loadData();
-            updateStatusBar();
-            restoreMachineSelection(selectedMachineId); // Восстанавливаем выделение
-            updateToolbarButtonsState();
-            QMessageBox::information(this, "Редактирование",
-                                   QString("Техника \"%1\" успешно обновлена").arg(updatedMachine->getName()));
-        } else {
-            QMessageBox::critical(this, "Ошибка", "Не удалось обновить технику в базе данных");
-        }
+        FleetDatabase::instance().updateMachineAsync(updatedMachine)
+            .then(this, [this, name = updatedMachine->getName()](const bool success) {
+                if (success) {
+                    QMessageBox::information(this, "Редактирование",
+                                           QString("Техника \"%1\" успешно обновлена").arg(name));
+                } else {
+                    QMessageBox::critical(this, "Ошибка", "Не удалось обновить технику в базе данных");
+                }
+            });
     }
 }
 
@@ -379,15 +405,13 @@ void MainWindow::onDeleteMachine()
                                       QMessageBox::Yes | QMessageBox::No);
     
     if (reply == QMessageBox::Yes) {
-        if (FleetDatabase::instance().deleteMachine(machine->getId())) {
-            m_tableModel->loadData();
-            updateStatusBar();
-            updateDetailsPanel(nullptr);
-            updateToolbarButtonsState();
-            QMessageBox::information(this, "Удаление", "Техника успешно удалена");
-        } else {
-            QMessageBox::critical(this, "Ошибка", "Не удалось удалить технику");
-        }
+        FleetDatabase::instance().deleteMachineAsync(machine->getId()).then(this, [this](const bool success) {
+            if (success) {
+                QMessageBox::information(this, "Удаление", "Техника успешно удалена");
+            } else {
+                QMessageBox::critical(this, "Ошибка", "Не удалось удалить технику");
+            }
+        });
     }
 }
 
@@ -396,12 +420,12 @@ void MainWindow::onAddProject()
     ProjectDialog dialog(this);
     if (dialog.exec() == QDialog::Accepted) {
         const auto project = dialog.getProject();
-        if (FleetDatabase::instance().addProject(project)) {
-            m_projectTableModel->refresh();
-            updateToolbarButtonsState();
-            QMessageBox::information(this, "Добавление",
-                                   QString("Проект \"%1\" успешно добавлен").arg(project->getName()));
-        } else QMessageBox::critical(this, "Ошибка", "Не удалось добавить проект");
+        FleetDatabase::instance().addProjectAsync(project).then(this, [this, name = project->getName()](const int id) {
+            if (id > 0) {
+                QMessageBox::information(this, "Добавление",
+                                       QString("Проект \"%1\" успешно добавлен").arg(name));
+            } else QMessageBox::critical(this, "Ошибка", "Не удалось добавить проект");
+        });
     }
 }
 
@@ -416,12 +440,13 @@ void MainWindow::onEditProject()
     ProjectDialog dialog(this, project);
     if (dialog.exec() == QDialog::Accepted) {
         const auto updatedProject = dialog.getProject();
-        if (FleetDatabase::instance().updateProject(updatedProject)) {
-            m_projectTableModel->refresh();
-            updateToolbarButtonsState();
-            QMessageBox::information(this, "Редактирование",
-                                   QString("Проект \"%1\" успешно обновлен").arg(updatedProject->getName()));
-        } else QMessageBox::critical(this, "Ошибка", "Не удалось обновить проект");
+        FleetDatabase::instance().updateProjectAsync(updatedProject)
+            .then(this, [this, name = updatedProject->getName()](const bool success) {
+                if (success) {
+                    QMessageBox::information(this, "Редактирование",
+                                           QString("Проект \"%1\" успешно обновлен").arg(name));
+                } else QMessageBox::critical(this, "Ошибка", "Не удалось обновить проект");
+            });
     }
 }
 
@@ -434,15 +459,15 @@ void MainWindow::onDeleteProject()
     }
     
     // Проверяем, есть ли машины на этом проекте
-    auto machinesOnProject = FleetDatabase::instance().getMachinesByProject(project->getName());
+    const int machinesOnProject = FleetDatabase::instance().countMachinesOnProject(project->getId());
     
-    if (!machinesOnProject.isEmpty()) {
+    if (machinesOnProject > 0) {
         QMessageBox::warning(this, "Удаление невозможно",
             QString("Невозможно удалить проект \"%1\".\n"
                     "На проекте работают %2 единиц техники.\n"
                     "Сначала верните всю технику с проекта.")
             .arg(project->getName())
-            .arg(machinesOnProject.size()));
+            .arg(machinesOnProject));
         return;
     }
     
@@ -451,11 +476,10 @@ void MainWindow::onDeleteProject()
                                       QMessageBox::Yes | QMessageBox::No);
     
     if (reply == QMessageBox::Yes) {
-        if (FleetDatabase::instance().deleteProject(project->getId())) {
-            m_projectTableModel->refresh();
-            updateToolbarButtonsState();
-            QMessageBox::information(this, "Удаление", "Проект успешно удален");
-        } else QMessageBox::critical(this, "Ошибка", "Не удалось удалить проект");
+        FleetDatabase::instance().deleteProjectAsync(project->getId()).then(this, [this](const bool success) {
+            if (success) QMessageBox::information(this, "Удаление", "Проект успешно удален");
+            else QMessageBox::critical(this, "Ошибка", "Не удалось удалить проект");
+        });
     }
 }
 
@@ -467,25 +491,21 @@ void MainWindow::onAssignToProject()
         return;
     }
     
-    int selectedMachineId = machine->getId();
-    
     // Если машина на объекте - вернуть с проекта
     if (machine->getStatus() == MachineStatus::OnSite) {
         machine->setStatus(MachineStatus::Available);
+        machine->setProjectId(0);
         machine->setCurrentProject("");
         machine->setAssignedDate(QDate());
         
-        if (FleetDatabase::instance().updateMachine(machine)) {
-            const QSignalBlocker blocker(m_tableView->selectionModel());
-            m_tableModel->loadData();
-            updateStatusBar();
-            restoreMachineSelection(selectedMachineId);
-            updateToolbarButtonsState();
-            QMessageBox::information(this, "Возврат с проекта",
-                                   QString("Техника \"%1\" возвращена в парк").arg(machine->getName()));
-        } else {
-            QMessageBox::critical(this, "Ошибка", "Не удалось обновить статус техники");
-        }
+        FleetDatabase::instance().updateMachineAsync(machine).then(this, [this, machine](const bool success) {
+            if (success) {
+                QMessageBox::information(this, "Возврат с проекта",
+                                       QString("Техника \"%1\" возвращена в парк").arg(machine->getName()));
+            } else {
+                QMessageBox::critical(this, "Ошибка", "Не удалось обновить статус техники");
+            }
+        });
         return;
     }
     
@@ -505,21 +525,19 @@ void MainWindow::onAssignToProject()
         }
         
         machine->setStatus(MachineStatus::OnSite);
+        machine->setProjectId(project->getId());
         machine->setCurrentProject(project->getName());
         machine->setAssignedDate(QDate::currentDate());
         
-        if (FleetDatabase::instance().updateMachine(machine)) {
-            const QSignalBlocker blocker(m_tableView->selectionModel());
-            m_tableModel->loadData();
-            updateStatusBar();
-            restoreMachineSelection(selectedMachineId);
-            updateToolbarButtonsState();
-            QMessageBox::information(this, "Назначение на проект",
-                                   QString("Техника \"%1\" назначена на проект \"%2\"")
-                                   .arg(machine->getName(), project->getName()));
-        } else {
-            QMessageBox::critical(this, "Ошибка", "Не удалось назначить технику на проект");
-        }
+        FleetDatabase::instance().updateMachineAsync(machine).then(this, [this, machine, project](const bool success) {
+            if (success) {
+                QMessageBox::information(this, "Назначение на проект",
+                                       QString("Техника \"%1\" назначена на проект \"%2\"")
+                                       .arg(machine->getName(), project->getName()));
+            } else {
+                QMessageBox::critical(this, "Ошибка", "Не удалось назначить технику на проект");
+            }
+        });
     }
 }
 
@@ -538,8 +556,6 @@ void MainWindow::onSendToRepair()
         return;
     }
     
-    int selectedMachineId = machine->getId();
-    
     if (machine->getStatus() == MachineStatus::Decommissioned) {
         QMessageBox::warning(this, "Операция с ремонтом", "Списанную технику нельзя отправить в ремонт");
         return;
@@ -549,17 +565,14 @@ void MainWindow::onSendToRepair()
     if (machine->getStatus() == MachineStatus::InRepair) {
         machine->setStatus(MachineStatus::Available);
         
-        if (FleetDatabase::instance().updateMachine(machine)) {
-            const QSignalBlocker blocker(m_tableView->selectionModel());
-            m_tableModel->loadData();
-            updateStatusBar();
-            restoreMachineSelection(selectedMachineId);
-            updateToolbarButtonsState();
-            QMessageBox::information(this, "Возврат из ремонта",
-                                   QString("Техника \"%1\" возвращена из ремонта").arg(machine->getName()));
-        } else {
-            QMessageBox::critical(this, "Ошибка", "Не удалось обновить статус техники");
-        }
+        FleetDatabase::instance().updateMachineAsync(machine).then(this, [this, machine](const bool success) {
+            if (success) {
+                QMessageBox::information(this, "Возврат из ремонта",
+                                       QString("Техника \"%1\" возвращена из ремонта").arg(machine->getName()));
+            } else {
+                QMessageBox::critical(this, "Ошибка", "Не удалось обновить статус техники");
+            }
+        });
         return;
     }
     
@@ -569,21 +582,19 @@ void MainWindow::onSendToRepair()
     
     // Если машина была на объекте - снять её с проекта
     if (oldStatus == MachineStatus::OnSite) {
+        machine->setProjectId(0);
         machine->setCurrentProject("");
         machine->setAssignedDate(QDate());
     }
     
-    if (FleetDatabase::instance().updateMachine(machine)) {
-        const QSignalBlocker blocker(m_tableView->selectionModel());
-        m_tableModel->loadData();
-        updateStatusBar();
-        restoreMachineSelection(selectedMachineId);
-        updateToolbarButtonsState();
-        QMessageBox::information(this, "Отправка в ремонт",
-                               QString("Техника \"%1\" отправлена в ремонт").arg(machine->getName()));
-    } else {
-        QMessageBox::critical(this, "Ошибка", "Не удалось обновить статус техники");
-    }
+    FleetDatabase::instance().updateMachineAsync(machine).then(this, [this, machine](const bool success) {
+        if (success) {
+            QMessageBox::information(this, "Отправка в ремонт",
+                                   QString("Техника \"%1\" отправлена в ремонт").arg(machine->getName()));
+        } else {
+            QMessageBox::critical(this, "Ошибка", "Не удалось обновить статус техники");
+        }
+    });
 }
 
 void MainWindow::onTableSelectionChanged() const
@@ -603,6 +614,33 @@ void MainWindow::onStatusFilterChanged(int index) const
     updateStatusBar();
 }
 
+void MainWindow::onFilterExpressionChanged() const
+{
+    // editingFinished приходит и при уходе фокуса без правок
+    const QString text = ui->filterExpression->text().trimmed();
+    if (text == m_tableModel->filter().text() && !ui->filterExpression->property("invalid").toBool()) return;
+    
+    QString error;
+    const MachineFilter filter = MachineFilter::parse(text, &error);
+    
+    // Некорректное выражение подсвечивается, действующий фильтр не меняется
+    ui->filterExpression->setProperty("invalid", !error.isEmpty());
+    ui->filterExpression->style()->unpolish(ui->filterExpression);
+    ui->filterExpression->style()->polish(ui->filterExpression);
+    if (!error.isEmpty()) {
+        ui->statusbar->showMessage("Ошибка в фильтре: " + error, 5000);
+        return;
+    }
+    
+    m_tableModel->setFilter(filter);
+    updateStatusBar();
+}
+
+void MainWindow::onSearchTextChanged() const
+{
+    m_tableModel->setSearchText(ui->searchEdit->text());
+}
+
 void MainWindow::updateDetailsPanel(const MachinePtr& machine) const
 {
     if (!machine) {
@@ -646,8 +684,7 @@ void MainWindow::updateDetailsPanel(const MachinePtr& machine) const
     Money cost = machine->getCost();
     QString costText = cost.toString();
     if (cost.getCurrency() != Currency::RUB) {
-        double rubAmount = cost.getAmount() * FleetDatabase::instance().getCurrencyRate(Money::getCurrencyName(cost.getCurrency()), "RUB");
-        costText += QString(" (%1)").arg(Money(rubAmount, Currency::RUB).toString());
+        costText += QString(" (%1)").arg(cost.convertTo(Currency::RUB).toString());
     }
     m_detailsCost->setText(costText);
     
@@ -741,30 +778,33 @@ void MainWindow::showColumnHeaderMenu(const QPoint& pos)
 void MainWindow::updateStatusBar() const
 {
     if (m_stackedWidget->currentIndex() == 0) {
-        // Fleet view - show machine statistics
-        const auto stats = FleetDatabase::instance().getStatistics();
-        ui->statusbar->showMessage(QString("Всего: %1 | Свободно: %2 | На объектах: %3 | В ремонте: %4 | Списано: %5")
-                                   .arg(stats.total)
-                                   .arg(stats.available)
-                                   .arg(stats.onSite)
-                                   .arg(stats.inRepair)
-                                   .arg(stats.decommissioned));
+        // Fleet view - show machine statistics (счётчики в памяти, без запроса к базе)
+        const FleetDatabase::Statistics stats = FleetDatabase::instance().getStatistics();
+        QString message = QString("Всего: %1 | Свободно: %2 | На объектах: %3 | В ремонте: %4 | Списано: %5")
+                          .arg(stats.total)
+                          .arg(stats.available)
+                          .arg(stats.onSite)
+                          .arg(stats.inRepair)
+                          .arg(stats.decommissioned);
+        if (m_tableModel->isSearchTruncated())
+            message += " | Поиск: показаны не все совпадения, уточните запрос";
+        ui->statusbar->showMessage(message);
     } else if (m_stackedWidget->currentIndex() == 1) {
-        // Projects view - show project statistics
-        const auto allProjects = FleetDatabase::instance().getAllProjects();
-        int totalProjects = allProjects.size();
-        int activeProjects = 0;
-        
-        for (const auto& project : allProjects) {
-            auto machines = FleetDatabase::instance().getMachinesByProject(project->getName());
-            if (!machines.isEmpty()) {
-                activeProjects++;
-            }
-        }
-        
-        ui->statusbar->showMessage(QString("Всего проектов: %1 | С техникой: %2")
-                                   .arg(totalProjects)
-                                   .arg(activeProjects));
+        // Projects view - show project statistics (один сгруппированный запрос в фоновом потоке)
+        QStatusBar *statusBar = ui->statusbar;
+        QStackedWidget *stackedWidget = m_stackedWidget;
+        FleetDatabase::instance().getProjectStatisticsAsync().then(statusBar,
+            [statusBar, stackedWidget](const QHash<int, FleetDatabase::ProjectStatistics>& statistics) {
+                if (stackedWidget->currentIndex() != 1) return;
+                
+                int activeProjects = 0;
+                for (const auto& stats : statistics)
+                    if (stats.machines.total > 0) activeProjects++;
+                
+                statusBar->showMessage(QString("Всего проектов: %1 | С техникой: %2")
+                                       .arg(statistics.size())
+                                       .arg(activeProjects));
+            });
     }
 }
 
@@ -813,27 +853,40 @@ void MainWindow::updateToolbarButtonsState()
     updateActionTexts();
 }
 
-int MainWindow::saveSelectedMachineId() const
+void MainWindow::onMachineChanged(const ChangeEvent& event)
 {
-    const auto machine = getSelectedMachine();
-    return machine ? machine->getId() : -1;
+    // Таблица уже обновлена моделью; статистика зависит только от состава парка,
+    // статусов и привязки к проектам
+    if (event.operation != ChangeEvent::Operation::Updated
+        || event.fields.testFlag(ChangeEvent::Status)
+        || event.fields.testFlag(ChangeEvent::CurrentProject))
+        updateStatusBar();
+    
+    const auto selected = getSelectedMachine();
+    if (!selected || selected->getId() == event.id)
+        updateDetailsPanel(selected);
+    
+    updateToolbarButtonsState();
 }
 
-void MainWindow::restoreMachineSelection(int machineId)
+void MainWindow::onMachinesReset()
 {
-    if (machineId <= 0) return;
+    // Модель перезагружается, выделение сброшено
+    updateStatusBar();
+    updateDetailsPanel(getSelectedMachine());
+    updateToolbarButtonsState();
+}
+
+void MainWindow::onProjectChanged(const ChangeEvent& event)
+{
+    if (event.operation != ChangeEvent::Operation::Updated)
+        updateStatusBar();
     
-    // Ищем машину с заданным ID в модели
-    for (int row = 0; row < m_tableModel->rowCount(); ++row) {
-        const auto machine = m_tableModel->getMachine(row);
-        if (machine && machine->getId() == machineId) {
-            // Выбираем эту строку
-            QModelIndex index = m_tableModel->index(row, 0);
-            m_tableView->setCurrentIndex(index);
-            m_tableView->selectionModel()->select(index, QItemSelectionModel::Select | QItemSelectionModel::Rows);
-            return;
-        }
-    }
+    // Модель техники уже подставила новое название проекта
+    if (event.fields.testFlag(ChangeEvent::ProjectName))
+        updateDetailsPanel(getSelectedMachine());
+    
+    updateToolbarButtonsState();
 }
 
 void MainWindow::updateActionTexts()
@@ -17,6 +17,8 @@ class QLabel;
 class QVBoxLayout;
 class QComboBox;
 class QStackedWidget;
+class QTimer;
+struct ChangeEvent;
 
 /**
  * @brief Главное окно приложения "Парк техники"
@@ -64,6 +66,12 @@ private slots:
     // Слот для фильтрации по статусу
     void onStatusFilterChanged(int index) const;
     
+    // Слот для составного фильтра (поле выражения под фильтром по статусу)
+    void onFilterExpressionChanged() const;
+    
+    // Слот для полнотекстового поиска (вызывается после паузы в наборе)
+    void onSearchTextChanged() const;
+    
     // Слот для контекстного меню
     void showContextMenu(const QPoint& pos);
     void showProjectContextMenu(const QPoint& pos);
@@ -114,14 +122,21 @@ private:
     void updateActionTexts();
     
     /**
-     * @brief Сохранить ID выбранной машины
+     * @brief Обновить статусбар, панель деталей и toolbar после изменения техники
+     * @param event Описание изменения из FleetDatabase
+     */
+    void onMachineChanged(const ChangeEvent& event);
+    
+    /**
+     * @brief Обновить статусбар, панель деталей и toolbar после пакетного изменения техники
      */
-    int saveSelectedMachineId() const;
+    void onMachinesReset();
     
     /**
-     * @brief Восстановить выбор машины по ID
+     * @brief Обновить статусбар и toolbar после изменения проекта
+     * @param event Описание изменения из FleetDatabase
      */
-    void restoreMachineSelection(int machineId);
+    void onProjectChanged(const ChangeEvent& event);
     
     /**
      * @brief Получить выбранную технику из таблицы
@@ -142,6 +157,7 @@ private:
     // Вид техники
     MachineTableModel *m_tableModel;
     QTableView *m_tableView;
+    QTimer *m_searchTimer;      // Задержка поиска при наборе текста
     
     // Вид проектов
     ProjectTableModel *m_projectTableModel;
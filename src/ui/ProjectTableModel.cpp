@@ -1,10 +1,19 @@
 #include "ProjectTableModel.h"
-#include "../database/FleetDatabase.h"
+#include <QTimer>
 
 ProjectTableModel::ProjectTableModel(QObject* parent)
     : QAbstractTableModel(parent)
 {
     refresh();
+    
+    connect(&FleetDatabase::instance(), &FleetDatabase::projectChanged,
+            this, &ProjectTableModel::onProjectChanged);
+    connect(&FleetDatabase::instance(), &FleetDatabase::machineChanged,
+            this, &ProjectTableModel::onMachineChanged);
+    connect(&FleetDatabase::instance(), &FleetDatabase::machinesReset,
+            this, &ProjectTableModel::scheduleStatisticsRefresh);
+    connect(&FleetDatabase::instance(), &FleetDatabase::currencyRateChanged,
+            this, &ProjectTableModel::scheduleStatisticsRefresh);
 }
 
 int ProjectTableModel::rowCount(const QModelIndex& parent) const
@@ -31,12 +40,16 @@ QVariant ProjectTableModel::data(const QModelIndex& index, int role) const
             case Id: return project->getId();
             case Name: return project->getName();
             case Description: return project->getDescription();
+            case MachineCount: return m_statistics.value(project->getId()).machines.total;
+            case TotalValue: return Money(m_statistics.value(project->getId()).totalValueRub, Currency::RUB).toString();
         }
     }
 
     if (role == Qt::TextAlignmentRole) {
         if (index.column() == Id)
             return Qt::AlignCenter;
+        if (index.column() == MachineCount || index.column() == TotalValue)
+            return QVariant(Qt::AlignRight | Qt::AlignVCenter);
     }
 
     return QVariant();
@@ -51,6 +64,8 @@ QVariant ProjectTableModel::headerData(int section, Qt::Orientation orientation,
         case Id: return "ID";
         case Name: return "Название";
         case Description: return "Описание";
+        case MachineCount: return "Техника";
+        case TotalValue: return "Стоимость техники";
     }
 
     return QVariant();
@@ -61,6 +76,8 @@ void ProjectTableModel::refresh()
     beginResetModel();
     m_projects = FleetDatabase::instance().getAllProjects();
     endResetModel();
+    
+    refreshStatistics();
 }
 
 ProjectPtr ProjectTableModel::getProject(int row) const
@@ -69,3 +86,70 @@ ProjectPtr ProjectTableModel::getProject(int row) const
         return nullptr;
     return m_projects[row];
 }
+
+void ProjectTableModel::onProjectChanged(const ChangeEvent& event)
+{
+    const int row = rowById(event.id);
+    
+    if (event.operation == ChangeEvent::Operation::Deleted) {
+        if (row < 0) return;
+        beginRemoveRows(QModelIndex(), row, row);
+        m_projects.remove(row);
+        endRemoveRows();
+        return;
+    }
+    
+    const ProjectPtr project = FleetDatabase::instance().getProjectById(event.id);
+    if (!project) return;
+    
+    if (row < 0) {
+        // Проекты упорядочены по ID - новый проект в конец
+        const int newRow = m_projects.size();
+        beginInsertRows(QModelIndex(), newRow, newRow);
+        m_projects.append(project);
+        endInsertRows();
+        return;
+    }
+    
+    m_projects[row] = project;
+    emit dataChanged(index(row, 0), index(row, ColumnCount - 1));
+}
+
+void ProjectTableModel::onMachineChanged(const ChangeEvent& event)
+{
+    // Сводка зависит только от состава техники, статуса, проекта и стоимости
+    if (event.operation == ChangeEvent::Operation::Updated
+        && !(event.fields & (ChangeEvent::Status | ChangeEvent::CurrentProject | ChangeEvent::Cost)))
+        return;
+    
+    scheduleStatisticsRefresh();
+}
+
+void ProjectTableModel::scheduleStatisticsRefresh()
+{
+    if (m_statisticsRefreshPending) return;
+    m_statisticsRefreshPending = true;
+    QTimer::singleShot(0, this, &ProjectTableModel::refreshStatistics);
+}
+
+void ProjectTableModel::refreshStatistics()
+{
+    m_statisticsRefreshPending = false;
+    const int generation = ++m_statisticsGeneration;
+    
+    FleetDatabase::instance().getProjectStatisticsAsync()
+        .then(this, [this, generation](const QHash<int, FleetDatabase::ProjectStatistics>& statistics) {
+            if (generation != m_statisticsGeneration) return;
+            m_statistics = statistics;
+            if (!m_projects.isEmpty())
+                emit dataChanged(index(0, MachineCount), index(m_projects.size() - 1, TotalValue));
+        });
+}
+
+int ProjectTableModel::rowById(const int projectId) const
+{
+    for (int i = 0; i < m_projects.size(); ++i)
+        if (m_projects[i]->getId() == projectId)
+            return i;
+    return -1;
+}
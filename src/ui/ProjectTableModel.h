@@ -1,11 +1,17 @@
 #pragma once
 
 #include <QAbstractTableModel>
+#include <QHash>
 #include <QVector>
 #include "../models/Project.h"
+#include "../database/FleetDatabase.h"
 
 /**
  * @brief Модель таблицы для отображения списка проектов
+ *
+ * Кроме данных проекта показывает количество и стоимость техники на нём.
+ * Сводка считается одним сгруппированным запросом в фоновом потоке и
+ * пересчитывается после изменений техники, проектов и курсов.
  */
 class ProjectTableModel : public QAbstractTableModel {
     Q_OBJECT
@@ -15,6 +21,8 @@ public:
         Id = 0,
         Name,
         Description,
+        MachineCount,
+        TotalValue,
         ColumnCount
     };
 
@@ -37,5 +45,36 @@ public:
     ProjectPtr getProject(int row) const;
 
 private:
+    /**
+     * @brief Применить изменение проекта из FleetDatabase к модели
+     * @param event Описание изменения
+     */
+    void onProjectChanged(const ChangeEvent& event);
+    
+    /**
+     * @brief Найти строку проекта по ID
+     * @return Индекс строки или -1
+     */
+    int rowById(int projectId) const;
+    
+    /**
+     * @brief Пересчитать сводку по проектам при изменении техники
+     * @param event Описание изменения техники
+     */
+    void onMachineChanged(const ChangeEvent& event);
+    
+    /**
+     * @brief Запланировать пересчёт сводки (несколько изменений подряд - один запрос)
+     */
+    void scheduleStatisticsRefresh();
+    
+    /**
+     * @brief Запросить сводку по проектам в фоновом потоке
+     */
+    void refreshStatistics();
+    
     QVector<ProjectPtr> m_projects;
+    QHash<int, FleetDatabase::ProjectStatistics> m_statistics;  // Сводка по ID проекта
+    bool m_statisticsRefreshPending = false;
+    int m_statisticsGeneration = 0;          // Номер запроса для отбрасывания устаревших ответов
 };
@@ -8,6 +8,8 @@
 #include <QHBoxLayout>
 #include <QPushButton>
 #include <QGroupBox>
+#include <QComboBox>
+#include <QSettings>
 
 SettingsDialog::SettingsDialog(QWidget *parent)
     : QDialog(parent)
@@ -18,6 +20,7 @@ SettingsDialog::SettingsDialog(QWidget *parent)
     ui->setupUi(this);
     setupUI();
     loadRates();
+    loadStorageProfiles();
 }
 
 SettingsDialog::~SettingsDialog()
@@ -46,7 +49,7 @@ void SettingsDialog::setupUI()
             padding: 12px;
             color: #d4d4d4;
         }
-        QDoubleSpinBox {
+        QDoubleSpinBox, QComboBox {
             background-color: #3c3c3c;
             color: #d4d4d4;
             border: 1px solid #555555;
@@ -78,6 +81,40 @@ void SettingsDialog::loadRates()
     ui->rubToUsdSpinBox->setValue(m_rubToUsdRate);
 }
 
+void SettingsDialog::loadStorageProfiles()
+{
+    const QString currentId = FleetDatabase::instance().storageProfile().id;
+    
+    for (const StorageProfile& profile : StorageProfile::all()) {
+        ui->storageProfileCombo->addItem(profile.title, profile.id);
+        if (profile.id == currentId)
+            ui->storageProfileCombo->setCurrentIndex(ui->storageProfileCombo->count() - 1);
+    }
+    
+    updateStorageProfileHint();
+    connect(ui->storageProfileCombo, &QComboBox::currentIndexChanged,
+            this, &SettingsDialog::updateStorageProfileHint);
+}
+
+void SettingsDialog::updateStorageProfileHint()
+{
+    const StorageProfile& profile = StorageProfile::byId(ui->storageProfileCombo->currentData().toString());
+    ui->storageProfileHint->setText(profile.description);
+}
+
+bool SettingsDialog::applyStorageProfile()
+{
+    const QString profileId = ui->storageProfileCombo->currentData().toString();
+    if (profileId == FleetDatabase::instance().storageProfile().id) return true;
+    
+    if (!FleetDatabase::instance().setStorageProfile(StorageProfile::byId(profileId)))
+        return false;
+    
+    QSettings settings;
+    settings.setValue("storage/profile", profileId);
+    return true;
+}
+
 bool SettingsDialog::validate()
 {
     double usdRate = ui->usdToRubSpinBox->value();
@@ -111,6 +148,14 @@ void SettingsDialog::accept()
 {
     if (!validate()) return;
     
+    // Профиль может не примениться - курсы сохраняем только после него,
+    // чтобы при ошибке не оставить настройки сохранёнными наполовину
+    if (!applyStorageProfile()) {
+        QMessageBox::critical(this, "Ошибка", "Не удалось применить профиль хранения "
+                                              "(подробности в журнале). Оставлен прежний профиль.");
+        return;
+    }
+    
     double usdToRub = ui->usdToRubSpinBox->value();
     double rubToUsd = ui->rubToUsdSpinBox->value();
     
@@ -123,6 +168,6 @@ void SettingsDialog::accept()
         return;
     }
     
-    QMessageBox::information(this, "Успешно", "Курсы валют сохранены");
+    QMessageBox::information(this, "Успешно", "Настройки сохранены");
     QDialog::accept();
 }
@@ -9,7 +9,8 @@ QT_END_NAMESPACE
 /**
  * @brief Диалог для редактирования настроек приложения
  * 
- * Позволяет пользователю установить курсы обмена валют USD/RUB и RUB/USD.
+ * Позволяет пользователю установить курсы обмена валют USD/RUB и RUB/USD
+ * и выбрать профиль хранения базы данных.
  */
 class SettingsDialog : public QDialog {
     Q_OBJECT
@@ -24,6 +25,9 @@ protected:
 private:
     void setupUI();
     void loadRates();
+    void loadStorageProfiles();
+    void updateStorageProfileHint();
+    bool applyStorageProfile();
     bool validate();
     
     Ui::SettingsDialog *ui;